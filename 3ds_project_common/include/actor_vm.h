@@ -0,0 +1,144 @@
+#ifndef ACTOR_VM_H
+#define ACTOR_VM_H
+
+#include <cstdint>
+#include <cstdio>
+
+// Small register-based bytecode VM for data-driven actors: ghost
+// personalities, timed events and level rules. Scripts are written in a
+// text DSL, assembled on the host (linux/vm_assembler.cpp) and loaded
+// from level files as bytecode. The interpreter (linux/actor_vm.cpp) is
+// only built with the host tools until levels load scripts on device.
+//
+// Every actor owns a fixed register file and a few I/O ports; nothing is
+// allocated while scripts run. vmRun() executes at most a given number of
+// instructions per call, so a runaway script only uses up its own budget
+// and carries on from the same place next tick.
+//
+// Instructions are 32 bits:
+//   bits 0-7   opcode
+//   bits 8-11  register a (usually the destination)
+//   bits 12-15 register b
+//   bits 16-19 register c, or bits 16-31 a signed 16-bit immediate
+
+#define VM_REGISTERS 16         // Registers per actor, r0-r15
+#define VM_MAX_CODE 4096        // Instructions in one program
+#define VM_MAX_SCRIPTS 32       // Named entry points in one program
+#define VM_NAME_SIZE 16         // Script name length, including the terminator
+#define VM_TICK_BUDGET 64       // Default instructions per actor per tick
+#define VM_FILE_MAGIC 0x314D5641 // "AVM1", start of an assembled program
+
+enum VmOp {
+    VM_HALT,    //                 stop this actor for good
+    VM_YIELD,   //                 end this tick, continue from the next instruction
+    VM_SLEEP,   // imm             yield for imm ticks
+    VM_LDI,     // a, imm          a = imm
+    VM_MOV,     // a, b            a = b
+    VM_ADD,     // a, b, c         a = b + c
+    VM_SUB,     // a, b, c         a = b - c
+    VM_MUL,     // a, b, c         a = b * c
+    VM_ADDI,    // a, b, imm       a = b + imm
+    VM_SHR,     // a, b, imm       a = b >> imm (arithmetic)
+    VM_AND,     // a, b, c         a = b & c
+    VM_MIN,     // a, b, c         a = min(b, c)
+    VM_MAX,     // a, b, c         a = max(b, c)
+    VM_ABS,     // a, b            a = |b|
+    VM_RAND,    // a, b            a = random in [0, b), 0 if b <= 0
+    VM_IN,      // a, port         a = port
+    VM_OUT,     // port, b         actor port = b
+    VM_JMP,     // imm             jump to imm
+    VM_JEQ,     // a, b, imm       jump to imm if a == b
+    VM_JNE,     // a, b, imm       jump to imm if a != b
+    VM_JLT,     // a, b, imm       jump to imm if a < b
+    VM_JLE,     // a, b, imm       jump to imm if a <= b
+    VM_OP_COUNT
+};
+
+// Ports below VM_GLOBAL_PORTS are shared, read-only inputs filled in by
+// the game each tick; the rest belong to the actor
+enum VmPort {
+    VM_PORT_TICK,
+    VM_PORT_PLAYER_X,
+    VM_PORT_PLAYER_Y,
+    VM_PORT_PLAYER_DX,      // Player heading, -1, 0 or 1
+    VM_PORT_PLAYER_DY,
+    VM_PORT_PELLETS,        // Pellets left in the maze
+    VM_GLOBAL_PORTS,
+
+    VM_PORT_SELF_X = VM_GLOBAL_PORTS, // Actor position, kept up to date by the game
+    VM_PORT_SELF_Y,
+    VM_PORT_TARGET_X,       // Tile the actor should head for
+    VM_PORT_TARGET_Y,
+    VM_PORT_MODE,           // Actor-defined state, e.g. chase/scatter/frightened
+    VM_PORT_EVENT,          // Non-zero asks the game to fire a level event
+    VM_PORT_COUNT
+};
+
+#define VM_ACTOR_PORTS (VM_PORT_COUNT - VM_GLOBAL_PORTS)
+
+// Port names as used by the assembler, by VmPort
+static const char* const VM_PORT_NAMES[VM_PORT_COUNT] = {
+    "tick", "player_x", "player_y", "player_dx", "player_dy", "pellets",
+    "self_x", "self_y", "target_x", "target_y", "mode", "event",
+};
+
+inline uint32_t vmEncode(VmOp op, unsigned a, unsigned b, unsigned c) {
+    return (uint32_t)op | (a & 15) << 8 | (b & 15) << 12 | (c & 15) << 16;
+}
+
+inline uint32_t vmEncodeImm(VmOp op, unsigned a, unsigned b, int imm) {
+    return (uint32_t)op | (a & 15) << 8 | (b & 15) << 12 | (uint32_t)(uint16_t)imm << 16;
+}
+
+struct VmScript {
+    char name[VM_NAME_SIZE];
+    uint16_t entry;         // First instruction
+};
+
+// A level's scripts: one block of code with named entry points
+struct VmProgram {
+    uint32_t code[VM_MAX_CODE];
+    uint16_t size;
+    uint16_t scriptCount;
+    VmScript scripts[VM_MAX_SCRIPTS];
+
+    // Index of the named script, or -1
+    int find(const char* name) const;
+};
+
+// Shared inputs for one tick
+struct VmGlobals {
+    int32_t ports[VM_GLOBAL_PORTS];
+};
+
+struct VmActor {
+    int32_t r[VM_REGISTERS];
+    int32_t ports[VM_ACTOR_PORTS];  // Indexed by VmPort - VM_GLOBAL_PORTS
+    uint32_t seed;                  // RAND state, never 0
+    uint16_t pc;
+    uint16_t sleep;                 // Ticks left to sleep
+    bool halted;
+    uint32_t overruns;              // Ticks cut short by the instruction budget
+
+    // Start the actor at a script's entry point
+    void reset(const VmProgram& program, int script, uint32_t seed);
+
+    int32_t port(VmPort p) const { return ports[p - VM_GLOBAL_PORTS]; }
+    void setPort(VmPort p, int32_t value) { ports[p - VM_GLOBAL_PORTS] = value; }
+};
+
+// Check every instruction's opcode, port and jump target so vmRun() can
+// skip those checks. Returns false and describes the first problem.
+bool vmValidate(const VmProgram& program, char* error, size_t errorSize);
+
+// Run one actor until it yields, sleeps, halts or uses up budget
+// instructions. The program must have passed vmValidate(). Returns the
+// number of instructions executed.
+unsigned vmRun(const VmProgram& program, VmActor& actor, const VmGlobals& globals, unsigned budget);
+
+// Assembled program file: magic, size, script count, scripts, code.
+// Both load and save validate the program.
+bool vmLoad(const char* path, VmProgram& program, char* error, size_t errorSize);
+bool vmSave(const char* path, const VmProgram& program, char* error, size_t errorSize);
+
+#endif
@@ -0,0 +1,516 @@
+#ifndef GAME_CORE_H
+#define GAME_CORE_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "maze_layout.h"
+#include "ring_logger.h"
+#include "startup_profile.h"
+#include "score_log.h"
+#include "snapshot_buffer.h"
+
+// Game core shared by every variant. The platform details are policy
+// types picked at compile time, so the game loop has no virtual calls
+// and no runtime checks on configuration:
+//   Platform - init/exit, main loop condition, tick pacing, render thread, save path
+//   Renderer - draw() shows a FrameSnapshot (maze, status line); logLine() shows messages
+//   Input    - poll() returns the buttons pressed since the last tick
+//   Clock    - tick() once per simulation tick, says when the timer counts down;
+//              pause()/resume() keep paused time out of the countdown
+
+#define PACMAN_START_X 1
+#define PACMAN_START_Y 16
+#define PELLET_SCORE 10
+
+// Actor positions are fixed point: SUBTILE_UNITS per tile
+#define SUBTILE_SHIFT 8
+#define SUBTILE_UNITS (1 << SUBTILE_SHIFT)
+
+// Buttons reported by Input policies, independent of platform key codes
+enum Button {
+    BUTTON_A = 1 << 0,
+    BUTTON_B = 1 << 1,
+    BUTTON_X = 1 << 2,
+    BUTTON_START = 1 << 3,
+    BUTTON_SELECT = 1 << 4,
+    BUTTON_UP = 1 << 5,
+    BUTTON_DOWN = 1 << 6,
+    BUTTON_LEFT = 1 << 7,
+    BUTTON_RIGHT = 1 << 8
+};
+
+struct DifficultySetting {
+    const char* name;
+    int seconds;    // Time limit for a session
+    int speed;      // Pac-Man speed in sub-tile units per simulation tick
+    unsigned button; // Button that picks it on the difficulty screen
+};
+
+// At 30 ticks per second: about 9, 10 and 12 tiles per second
+static constexpr DifficultySetting DIFFICULTIES[] = {
+    { "Easy", 240, 77, BUTTON_A },    // 4 minutes
+    { "Medium", 150, 86, BUTTON_B },  // 2.5 minutes
+    { "Hard", 120, 102, BUTTON_X },   // 2 minutes
+};
+
+#define DIFFICULTY_COUNT (int)(sizeof(DIFFICULTIES) / sizeof(DIFFICULTIES[0]))
+
+// Every speed from difficulty i on is under half a tile per tick, so the
+// interpolated position rounds to every tile Pac-Man passes and the
+// rendered path never skips one
+constexpr bool speedsInterpolate(int i) {
+    return i == DIFFICULTY_COUNT || (DIFFICULTIES[i].speed < SUBTILE_UNITS / 2 && speedsInterpolate(i + 1));
+}
+
+static_assert(speedsInterpolate(0), "A difficulty is too fast to interpolate");
+
+static constexpr char MAZE_LAYOUT[MAZE_HEIGHT][MAZE_WIDTH + 1] = { MAZE_LAYOUT_ROWS };
+
+// Pellets in MAZE_LAYOUT, counted by the compiler
+constexpr int rowPellets(int y, int x) {
+    return x == MAZE_WIDTH ? 0 : (MAZE_LAYOUT[y][x] == '.') + rowPellets(y, x + 1);
+}
+
+constexpr int layoutPellets(int y) {
+    return y == MAZE_HEIGHT ? 0 : rowPellets(y, 0) + layoutPellets(y + 1);
+}
+
+static constexpr int MAZE_PELLETS = layoutPellets(0);
+
+static_assert(MAZE_LAYOUT[PACMAN_START_Y][PACMAN_START_X] != '#', "Pac-Man must start on an open tile");
+
+// Mutable copy of the maze for one session
+struct Maze {
+    char cells[MAZE_HEIGHT][MAZE_WIDTH + 1];
+    int pellets; // Pellets left to eat
+
+    // The layout and its pellet count are fixed at compile time; resetting is one copy
+    void reset() {
+        memcpy(cells, MAZE_LAYOUT, sizeof(cells));
+        pellets = MAZE_PELLETS;
+    }
+
+    bool isWall(int x, int y) const {
+        return x < 0 || x >= MAZE_WIDTH || y < 0 || y >= MAZE_HEIGHT || cells[y][x] == '#';
+    }
+
+    // Eat the pellet at (x, y) if there is one
+    bool consumeDot(int x, int y) {
+        if (cells[y][x] != '.') return false;
+        cells[y][x] = ' ';
+        pellets--;
+        return true;
+    }
+};
+
+class PacMan {
+public:
+    int x, y;            // Tile whose centre Pac-Man last reached
+    char direction;      // Requested movement direction ('U', 'D', 'L', 'R'), latched from input
+    char heading;        // Direction of travel towards the next tile, ' ' when stopped on a centre
+    int progress;        // Sub-tile units travelled from (x, y) along heading
+    int score;           // Current score of the player
+    int pelletsEaten;    // Pellets eaten this session
+
+    PacMan() { reset(); }
+
+    void reset() {
+        x = PACMAN_START_X;
+        y = PACMAN_START_Y;
+        direction = ' ';
+        heading = ' ';
+        progress = 0;
+        score = 0;
+        pelletsEaten = 0;
+    }
+
+    // Position in sub-tile units
+    int fixedX() const { return x * SUBTILE_UNITS + stepX(heading) * progress; }
+    int fixedY() const { return y * SUBTILE_UNITS + stepY(heading) * progress; }
+
+    // Advance speed sub-tile units. Turns, walls and pellets are only
+    // handled on tile centres, so the tile logic is the same at any speed.
+    void move(Maze& maze, int speed) {
+        if (heading == ' ' && !startMove(maze)) return;
+
+        progress += speed;
+        while (progress >= SUBTILE_UNITS) {
+            // Reached the centre of the next tile
+            x += stepX(heading);
+            y += stepY(heading);
+            progress -= SUBTILE_UNITS;
+
+            if (maze.consumeDot(x, y)) {
+                score += PELLET_SCORE;
+                pelletsEaten++;
+            }
+            if (!startMove(maze)) {
+                progress = 0; // Stop on the centre in front of the wall
+                break;
+            }
+        }
+    }
+
+private:
+    static int stepX(char d) { return d == 'L' ? -1 : d == 'R' ? 1 : 0; }
+    static int stepY(char d) { return d == 'U' ? -1 : d == 'D' ? 1 : 0; }
+
+    // On a tile centre: head in the requested direction if that tile is open
+    bool startMove(const Maze& maze) {
+        heading = direction != ' ' && isValidMove(x + stepX(direction), y + stepY(direction), maze) ? direction : ' ';
+        return heading != ' ';
+    }
+
+    bool isValidMove(int newX, int newY, const Maze& maze) const {
+        return !maze.isWall(newX, newY);
+    }
+};
+
+enum GameState {
+    STATE_TITLE,    // Waiting for A to start
+    STATE_CHOOSING, // Difficulty screen
+    STATE_PLAYING,
+    STATE_PAUSED
+};
+
+#define SIM_TICK_HZ 30          // Fixed simulation rate; rendering interpolates up to the display rate
+#define ALPHA_ONE 256           // Interpolation weight of the newest tick
+
+// Immutable copy of everything the renderer needs for one frame.
+// The simulation publishes one per tick; the renderer only reads it.
+struct FrameSnapshot {
+    unsigned tick;
+    unsigned long long publishUs; // Platform time when the tick was published
+    GameState state;
+    Maze maze;
+    PacMan pacman;
+    int remainingTime;
+    int prevX, prevY;             // Pac-Man in sub-tile units at the previous tick
+
+    // Pac-Man's drawn position: alpha runs from the previous tick (0) to this one (ALPHA_ONE)
+    int drawX(int alpha) const { return prevX + (pacman.fixedX() - prevX) * alpha / ALPHA_ONE; }
+    int drawY(int alpha) const { return prevY + (pacman.fixedY() - prevY) * alpha / ALPHA_ONE; }
+
+    // Tile the drawn position is closest to
+    static int nearestTile(int fixed) { return (fixed + SUBTILE_UNITS / 2) >> SUBTILE_SHIFT; }
+};
+
+typedef void (*ThreadEntry)(void*);
+
+// The simulation runs on the calling thread at SIM_TICK_HZ and publishes
+// snapshots through a triple buffer; a render thread started by the
+// platform draws the newest one each frame. The simulation never waits
+// for the renderer, so a slow frame can't delay movement or input.
+// Messages go through a LogRing and are formatted on the render thread.
+template <class Platform, class Renderer, class Input, class Clock>
+class Game {
+public:
+    // Only what the title screen needs is set up here. The maze is built
+    // when a session starts and saved scores are read in the background.
+    Game() : startup(Platform::nowUs()), state(STATE_TITLE), maze(), remainingTime(0), difficulty(0), sessionStartMs(0), pausedAtMs(0), pausedMs(0),
+             tick(0), publishedX(0), publishedY(0), startupReported(false), logFile(nullptr), stopping(false), scoreLog(Platform::scoreLogPath()) {
+        platform.init(); // Brings up graphics before the renderer touches the screens
+        startup.mark(STARTUP_PLATFORM, Platform::nowUs());
+        renderer.init();
+        startup.mark(STARTUP_RENDERER, Platform::nowUs());
+
+        log.write(LOG_TITLE);
+    }
+
+    ~Game() {
+        scoreLog.flush(); // Make sure the last session reaches the disk
+        renderer.exit();
+        platform.exit();
+    }
+
+    void run() {
+        publish(); // Give the renderer something to draw straight away
+        startup.mark(STARTUP_BOOT_STATE, Platform::nowUs());
+        platform.startRenderThread(renderEntry, this);
+        startup.mark(STARTUP_RENDER_THREAD, Platform::nowUs());
+
+        scoreLog.start(); // Saved scores are read on the writer thread
+        startup.mark(STARTUP_SCORE_LOG, Platform::nowUs());
+
+        while (platform.running()) {
+            clock.tick();
+            if (!update(input.poll())) break;
+            publish();
+            if (!startup.reached(STARTUP_FIRST_TICK)) startup.mark(STARTUP_FIRST_TICK, Platform::nowUs());
+            if (!startupReported && logFile && startup.reached(STARTUP_TITLE_SHOWN)) reportStartup();
+            platform.waitForTick();
+        }
+
+        stopping.store(true, std::memory_order_release);
+        platform.joinRenderThread();
+        drainLog(); // Anything logged after the last frame
+    }
+
+    // Advance the game by one tick; returns false when the player quits
+    bool update(unsigned buttons) {
+        tick++;
+        log.setTick(tick);
+        switch (state) {
+        case STATE_TITLE:
+            if (buttons & BUTTON_START) return false;
+            if (buttons & BUTTON_A) {
+                state = STATE_CHOOSING;
+                log.write(LOG_CLEAR);
+                log.write(LOG_CHOOSE_DIFFICULTY);
+            }
+            break;
+
+        case STATE_CHOOSING:
+            if (buttons & BUTTON_START) return false;
+            for (int i = 0; i < DIFFICULTY_COUNT; i++) {
+                if (buttons & DIFFICULTIES[i].button) {
+                    startSession(i);
+                    break;
+                }
+            }
+            break;
+
+        case STATE_PLAYING:
+            if (buttons & BUTTON_START) return false;
+            if (buttons & BUTTON_SELECT) {
+                state = STATE_PAUSED;
+                pausedAtMs = clock.nowMs();
+                clock.pause();
+                log.write(LOG_PAUSE_MENU);
+                break;
+            }
+            handleInput(buttons);
+            pacman.move(maze, DIFFICULTIES[difficulty].speed);
+            if (clock.secondElapsed() && remainingTime > 0) remainingTime--;
+
+            if (remainingTime <= 0 || maze.pellets == 0) endSession();
+            break;
+
+        case STATE_PAUSED:
+            if (buttons & BUTTON_A) {
+                state = STATE_PLAYING;
+                pausedMs += clock.nowMs() - pausedAtMs;
+                clock.resume(); // The pause doesn't count against the time limit
+                log.write(LOG_CLEAR);
+            } else if (buttons & BUTTON_START) {
+                state = STATE_TITLE; // Quit to the title screen
+                log.write(LOG_CLEAR);
+                log.write(LOG_PLAY_AGAIN);
+            }
+            break;
+        }
+        return true;
+    }
+
+    // Copy the current state into snapshot; called once per tick
+    void takeSnapshot(FrameSnapshot& snapshot) {
+        snapshot.tick = tick;
+        snapshot.publishUs = Platform::nowUs();
+        snapshot.state = state;
+        snapshot.maze = maze;
+        snapshot.pacman = pacman;
+        snapshot.remainingTime = remainingTime;
+        snapshot.prevX = publishedX;
+        snapshot.prevY = publishedY;
+        publishedX = pacman.fixedX();
+        publishedY = pacman.fixedY();
+    }
+
+    GameState currentState() const { return state; }
+    const PacMan& player() const { return pacman; }
+    const Maze& currentMaze() const { return maze; }
+    unsigned ticks() const { return tick; }
+    Platform& platformPolicy() { return platform; }
+    Input& inputPolicy() { return input; }
+    Renderer& rendererPolicy() { return renderer; }
+    LogRing& logRing() { return log; }
+
+    // Also copy every message to this file (formatted on the render thread)
+    void setLogFile(FILE* file) { logFile = file; }
+    const StartupProfile& startupProfile() const { return startup; }
+
+private:
+    StartupProfile startup; // Declared first so its clock starts before the other members are built
+    Platform platform;
+    Renderer renderer;
+    Input input;
+    Clock clock;
+
+    GameState state;
+    Maze maze;
+    PacMan pacman;
+    int remainingTime;
+    int difficulty;          // Index into DIFFICULTIES
+    unsigned sessionStartMs;
+    unsigned pausedAtMs;     // When the current pause started
+    unsigned pausedMs;       // Time spent paused this session, not counted as play
+    unsigned tick;
+    int publishedX, publishedY; // Pac-Man's position in the last snapshot
+    bool startupReported;
+
+    TripleBuffer<FrameSnapshot> snapshots;
+    LogRing log;
+    FILE* logFile;
+    std::atomic<bool> stopping;
+    ScoreLog scoreLog;
+
+    // Copy the current state into the free slot and hand it to the renderer
+    void publish() {
+        takeSnapshot(snapshots.back());
+        snapshots.publish();
+    }
+
+    // Once the title is up and the first tick done: when each step finished.
+    // Only written when there is a log file; drainLog keeps it off the screen.
+    void reportStartup() {
+        for (int i = 0; i < STARTUP_STEP_COUNT; i++) {
+            log.write(LOG_STARTUP_STEP, STARTUP_STEP_NAMES[i], (int)startup.at((StartupStep)i));
+        }
+        startupReported = true;
+    }
+
+    static void renderEntry(void* arg) {
+        static_cast<Game*>(arg)->renderLoop();
+    }
+
+    // Render thread: draw the newest snapshot every frame, moving Pac-Man
+    // between its last two tick positions, then use the rest of the frame
+    // to format and show waiting messages
+    void renderLoop() {
+        bool haveSnapshot = false;
+        while (!stopping.load(std::memory_order_acquire)) {
+            haveSnapshot = snapshots.consume() || haveSnapshot;
+            if (haveSnapshot) {
+                const FrameSnapshot& snapshot = snapshots.front();
+                unsigned long long sinceTick = Platform::nowUs() - snapshot.publishUs;
+                int alpha = (int)std::min<unsigned long long>(sinceTick * SIM_TICK_HZ * ALPHA_ONE / 1000000, ALPHA_ONE);
+                renderer.draw(snapshot, alpha);
+            }
+            drainLog();
+            platform.endFrame();
+            if (haveSnapshot && !startup.reached(STARTUP_TITLE_SHOWN)) startup.mark(STARTUP_TITLE_SHOWN, Platform::nowUs());
+        }
+    }
+
+    void drainLog() {
+        log.drain([this](unsigned format, unsigned stamp, const char* text) {
+            if (format != LOG_STARTUP_STEP) renderer.logLine(format, text); // Diagnostics, not for players
+            if (logFile && format != LOG_CLEAR) fprintf(logFile, "[%u] %s", stamp, text);
+        });
+    }
+
+    void startSession(int chosen) {
+        difficulty = chosen;
+        remainingTime = DIFFICULTIES[chosen].seconds;
+        maze.reset();
+        pacman.reset();
+        publishedX = pacman.fixedX(); // Don't slide in from the last session's position
+        publishedY = pacman.fixedY();
+        clock.reset();
+        sessionStartMs = clock.nowMs();
+        pausedMs = 0;
+        state = STATE_PLAYING;
+
+        log.write(LOG_CLEAR);
+        log.write(LOG_GAME_STARTED);
+    }
+
+    // Directions stay latched until another one is pressed
+    void handleInput(unsigned buttons) {
+        if (buttons & BUTTON_UP) pacman.direction = 'U';
+        else if (buttons & BUTTON_DOWN) pacman.direction = 'D';
+        else if (buttons & BUTTON_LEFT) pacman.direction = 'L';
+        else if (buttons & BUTTON_RIGHT) pacman.direction = 'R';
+    }
+
+    void endSession() {
+        bool cleared = maze.pellets == 0;
+
+        log.write(LOG_CLEAR);
+        if (cleared) log.write(LOG_ALL_DOTS);
+        log.write(LOG_GAME_OVER, pacman.score);
+
+        // Queue the session; the score log writes it in the background
+        SessionRecord record;
+        record.difficulty = difficulty;
+        record.cleared = cleared ? 1 : 0;
+        record.pelletsEaten = pacman.pelletsEaten;
+        record.score = pacman.score;
+        record.clearTimeMs = clock.nowMs() - sessionStartMs - pausedMs;
+        if (!scoreLog.submit(record)) log.write(LOG_SESSION_NOT_SAVED);
+
+        log.write(LOG_HIGH_SCORE, DIFFICULTIES[difficulty].name, scoreLog.highScore(difficulty));
+        log.write(LOG_PLAY_AGAIN);
+        state = STATE_TITLE;
+    }
+};
+
+// Clock that counts simulation ticks, for deterministic runs
+class FrameClock {
+public:
+    FrameClock() { reset(); }
+
+    void reset() {
+        frames = 0;
+        secondFrames = 0;
+        pausedSecondFrames = 0;
+    }
+
+    void tick() {
+        frames++;
+        secondFrames++;
+    }
+
+    bool secondElapsed() {
+        if (secondFrames < SIM_TICK_HZ) return false;
+        secondFrames = 0;
+        return true;
+    }
+
+    // Ticks keep coming while paused; carry the part-second over the pause
+    void pause() { pausedSecondFrames = secondFrames; }
+    void resume() { secondFrames = pausedSecondFrames; }
+
+    unsigned nowMs() const { return frames * 1000 / SIM_TICK_HZ; }
+
+private:
+    unsigned frames;
+    unsigned secondFrames;
+    unsigned pausedSecondFrames;
+};
+
+// Clock driven by a millisecond time source: TimeSource::nowMs()
+template <class TimeSource>
+class MillisClock {
+public:
+    MillisClock() { reset(); }
+
+    void reset() {
+        now = TimeSource::nowMs();
+        lastSecond = now;
+        pausedPartMs = 0;
+    }
+
+    void tick() { now = TimeSource::nowMs(); }
+
+    bool secondElapsed() {
+        if (now - lastSecond < 1000) return false;
+        lastSecond += 1000;
+        return true;
+    }
+
+    // Nothing checks secondElapsed() while paused; on resume, count on
+    // from where the interrupted second had got to
+    void pause() { pausedPartMs = now - lastSecond; }
+    void resume() { lastSecond = now - pausedPartMs; }
+
+    unsigned nowMs() const { return now; }
+
+private:
+    unsigned now;
+    unsigned lastSecond;
+    unsigned pausedPartMs;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef MAZE_LAYOUT_H
+#define MAZE_LAYOUT_H
+
+// The game's maze, shared by the game core and the GPU scene demo. Plain C
+// so both can include it: MAZE_LAYOUT_ROWS expands to the row strings, to
+// put inside the braces of a char[MAZE_HEIGHT][MAZE_WIDTH + 1] or const
+// char*[MAZE_HEIGHT] initializer. '#' is a wall and '.' a pellet.
+
+#define MAZE_WIDTH 49  // Columns in the maze
+#define MAZE_HEIGHT 19 // Rows in the maze
+
+#define MAZE_LAYOUT_ROWS \
+    "#################################################", \
+    "# ............................................. #", \
+    "# .###. .#### . #### . . . #### . ####. . ### . #", \
+    "# .###. .#### . #### . ## . . . . ####. . ### . #", \
+    "# . . . .#### . #### . ## . . . . . . . . . . . #", \
+    "####### . . . . #### . ## . . . . . . . . . . . #", \
+    "####### .#### . #### . ##  ## . . ### . . ### . #", \
+    "# . . . .#### . #### . ##  ## . . ### . . ### . #", \
+    "# . . . . . . . . . . . . . . . . . . . . . . . #", \
+    "####### . ######################### . ###########", \
+    "# . . . . ### . ### . . # . . . . . . . . . . . #", \
+    "# . . . . ### . ### . . #  ####  #### . . ####. #", \
+    "# . . . . . . . . . . . . . . . . . . . . . . . #", \
+    "####### .#### . ### . # . ### . ####. . .#### . #", \
+    "####### .#### . ### . # . . . . . . . . . . . . #", \
+    "####### .#### . ### . # . . . . . . . . . . . . #", \
+    "#       .#### . ### . # . ### . ### . . . ### . #", \
+    "#     # . . . . . . . . . . . . . . . . . . . . #", \
+    "#################################################"
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef POLICIES_3DS_H
+#define POLICIES_3DS_H
+
+#include <3ds.h>
+#include "game_core.h"
+
+// Policies for running the game on the 3DS
+
+#define TOP_PIXEL_WIDTH 400     // Top screen width in pixels
+#define TOP_PIXEL_HEIGHT 240    // Top screen height in pixels
+#define TILE_PIXEL_WIDTH 8      // Maze tile size on the framebuffer renderer
+#define TILE_PIXEL_HEIGHT 12
+#define RENDER_STACK_SIZE (32 * 1024)
+
+// Owns gfxInitDefault()/gfxExit() so graphics are always up before a renderer starts.
+// The simulation stays on the main thread (aptMainLoop() must run there);
+// rendering goes to the second application core.
+class CtrPlatform {
+public:
+    void init() {
+        gfxInitDefault();
+        nextTick = svcGetSystemTick();
+        renderThread = nullptr;
+    }
+
+    void exit() { gfxExit(); }
+    bool running() { return aptMainLoop(); }
+
+    // Sleep until the next simulation tick; if we fell behind, start again from now
+    void waitForTick() {
+        nextTick += SYSCLOCK_ARM11 / SIM_TICK_HZ;
+        u64 now = svcGetSystemTick();
+        if (now < nextTick) svcSleepThread((nextTick - now) * 1000000000ULL / SYSCLOCK_ARM11);
+        else nextTick = now;
+    }
+
+    // Called on the render thread once per frame
+    void endFrame() {
+        gfxFlushBuffers();
+        gfxSwapBuffers();
+        gspWaitForVBlank();
+    }
+
+    void startRenderThread(ThreadEntry entry, void* arg) {
+        // Render below the simulation so it can never hold up a tick if both share a core
+        s32 priority = 0x30;
+        svcGetThreadPriority(&priority, CUR_THREAD_HANDLE);
+
+        // Core 1 is the system core; the app may use part of its time
+        APT_SetAppCpuTimeLimit(30);
+        renderThread = threadCreate(entry, arg, RENDER_STACK_SIZE, priority + 1, 1, false);
+        if (!renderThread) renderThread = threadCreate(entry, arg, RENDER_STACK_SIZE, priority + 1, -2, false);
+    }
+
+    void joinRenderThread() {
+        if (!renderThread) return;
+        threadJoin(renderThread, U64_MAX);
+        threadFree(renderThread);
+        renderThread = nullptr;
+    }
+
+    static const char* scoreLogPath() { return "sdmc:/3ds/pacman_scores.log"; }
+
+    // Microseconds from the system tick counter, for render interpolation
+    static unsigned long long nowUs() { return (unsigned long long)(svcGetSystemTick() / CPU_TICKS_PER_USEC); }
+
+private:
+    u64 nextTick;
+    Thread renderThread;
+};
+
+struct HidInput {
+    unsigned poll() {
+        hidScanInput();
+        u32 kDown = hidKeysDown();
+        unsigned buttons = 0;
+
+        if (kDown & KEY_A) buttons |= BUTTON_A;
+        if (kDown & KEY_B) buttons |= BUTTON_B;
+        if (kDown & KEY_X) buttons |= BUTTON_X;
+        if (kDown & KEY_START) buttons |= BUTTON_START;
+        if (kDown & KEY_SELECT) buttons |= BUTTON_SELECT;
+        if (kDown & KEY_UP) buttons |= BUTTON_UP;
+        if (kDown & KEY_DOWN) buttons |= BUTTON_DOWN;
+        if (kDown & KEY_LEFT) buttons |= BUTTON_LEFT;
+        if (kDown & KEY_RIGHT) buttons |= BUTTON_RIGHT;
+        return buttons;
+    }
+};
+
+// Millisecond time source for MillisClock
+struct CtrTime {
+    static unsigned nowMs() { return (unsigned)osGetTime(); }
+};
+
+typedef MillisClock<CtrTime> CtrMillisClock;
+
+// Status line and messages always go to the bottom screen console
+class BottomConsole {
+public:
+    void init() { consoleInit(GFX_BOTTOM, &bottomConsole); }
+
+    void drawText(const FrameSnapshot& snapshot) {
+        if (snapshot.state != STATE_PLAYING) return;
+        consoleSelect(&bottomConsole);
+        printf("\x1b[s\x1b[1;1HScore: %d | Time Left: %d   \x1b[u", snapshot.pacman.score, snapshot.remainingTime);
+    }
+
+    // Runs on the render thread after the frame is drawn
+    void logLine(unsigned format, const char* text) {
+        consoleSelect(&bottomConsole);
+        if (format == LOG_CLEAR) {
+            consoleClear();
+            printf("\x1b[3;1H"); // Leave the first rows for the status line
+        } else {
+            printf("%s", text);
+        }
+    }
+
+private:
+    PrintConsole bottomConsole;
+};
+
+// Draws the maze as text on a top screen console
+// Pac-Man is shown on the tile nearest to its interpolated position.
+// The title only uses the bottom screen, so the top console is set up
+// on the first frame that draws the maze.
+class ConsoleRenderer : public BottomConsole {
+public:
+    void init() {
+        BottomConsole::init();
+        topReady = false;
+        lastTick = 0;
+        lastX = lastY = -1;
+    }
+
+    void exit() {}
+
+    void draw(const FrameSnapshot& snapshot, int alpha) {
+        int px = FrameSnapshot::nearestTile(snapshot.drawX(alpha));
+        int py = FrameSnapshot::nearestTile(snapshot.drawY(alpha));
+
+        // Text only changes when a tick lands or Pac-Man crosses into a new tile
+        if (snapshot.tick == lastTick && px == lastX && py == lastY) return;
+        lastTick = snapshot.tick;
+        lastX = px;
+        lastY = py;
+
+        if (snapshot.state == STATE_PLAYING) drawMaze(snapshot.maze, px, py);
+        drawText(snapshot);
+    }
+
+private:
+    PrintConsole topConsole;
+    bool topReady;
+    unsigned lastTick;
+    int lastX, lastY;
+
+    void drawMaze(const Maze& maze, int pacmanX, int pacmanY) {
+        if (!topReady) {
+            consoleInit(GFX_TOP, &topConsole);
+            topReady = true;
+        }
+        consoleSelect(&topConsole);
+        printf("\x1b[H"); // Move cursor to the top-left
+
+        for (int y = 0; y < MAZE_HEIGHT; y++) {
+            for (int x = 0; x < MAZE_WIDTH; x++) {
+                putchar(x == pacmanX && y == pacmanY ? 'P' : maze.cells[y][x]);
+            }
+            putchar('\n');
+        }
+    }
+};
+
+// Draws the maze as coloured tiles straight into the top framebuffer,
+// with Pac-Man placed to the pixel between tiles
+class FramebufferRenderer : public BottomConsole {
+public:
+    void init() { BottomConsole::init(); }
+    void exit() {}
+
+    void draw(const FrameSnapshot& snapshot, int alpha) {
+        if (snapshot.state == STATE_PLAYING) drawMaze(snapshot.maze, snapshot.drawX(alpha), snapshot.drawY(alpha));
+        drawText(snapshot);
+    }
+
+private:
+    void drawMaze(const Maze& maze, int pacmanX, int pacmanY) {
+        // The framebuffer is rotated: columns of 240 BGR pixels, bottom to top
+        u8* fb = gfxGetFramebuffer(GFX_TOP, GFX_LEFT, nullptr, nullptr);
+        int left = (TOP_PIXEL_WIDTH - MAZE_WIDTH * TILE_PIXEL_WIDTH) / 2;
+        int top = (TOP_PIXEL_HEIGHT - MAZE_HEIGHT * TILE_PIXEL_HEIGHT) / 2;
+
+        memset(fb, 0, TOP_PIXEL_WIDTH * TOP_PIXEL_HEIGHT * 3);
+        for (int y = 0; y < MAZE_HEIGHT; y++) {
+            for (int x = 0; x < MAZE_WIDTH; x++) {
+                int px = left + x * TILE_PIXEL_WIDTH;
+                int py = top + y * TILE_PIXEL_HEIGHT;
+
+                if (maze.cells[y][x] == '#') {
+                    fillRect(fb, px, py, TILE_PIXEL_WIDTH, TILE_PIXEL_HEIGHT, 0xC0, 0x20, 0x20); // Blue
+                } else if (maze.cells[y][x] == '.') {
+                    fillRect(fb, px + 3, py + 5, 2, 2, 0xFF, 0xFF, 0xFF); // White pellet
+                }
+            }
+        }
+
+        // Sub-tile position to pixels, drawn last so it covers the pellet it is eating
+        int px = left + pacmanX * TILE_PIXEL_WIDTH / SUBTILE_UNITS;
+        int py = top + pacmanY * TILE_PIXEL_HEIGHT / SUBTILE_UNITS;
+        fillRect(fb, px + 1, py + 2, TILE_PIXEL_WIDTH - 2, TILE_PIXEL_HEIGHT - 4, 0x00, 0xFF, 0xFF); // Yellow
+    }
+
+    static void fillRect(u8* fb, int px, int py, int w, int h, u8 b, u8 g, u8 r) {
+        for (int x = px; x < px + w; x++) {
+            u8* column = fb + x * TOP_PIXEL_HEIGHT * 3;
+            for (int y = py; y < py + h; y++) {
+                u8* pixel = column + (TOP_PIXEL_HEIGHT - 1 - y) * 3;
+                pixel[0] = b;
+                pixel[1] = g;
+                pixel[2] = r;
+            }
+        }
+    }
+};
+
+// The 3DS builds of the game
+typedef Game<CtrPlatform, ConsoleRenderer, HidInput, CtrMillisClock> ConsoleGame;
+typedef Game<CtrPlatform, FramebufferRenderer, HidInput, FrameClock> FramebufferGame;
+
+#endif
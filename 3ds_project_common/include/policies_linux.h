@@ -0,0 +1,222 @@
+#ifndef POLICIES_LINUX_H
+#define POLICIES_LINUX_H
+
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include "game_core.h"
+
+// Policies for running the game on a Linux host, either in a terminal
+// or headless for scripted runs.
+
+struct LinuxTime {
+    static unsigned nowMs() {
+        return (unsigned)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static unsigned long long nowUs() {
+        return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+typedef MillisClock<LinuxTime> LinuxMillisClock;
+
+// Render thread shared by the Linux platforms
+class LinuxRenderThread {
+public:
+    void startRenderThread(ThreadEntry entry, void* arg) { renderThread = std::thread(entry, arg); }
+
+    void joinRenderThread() {
+        if (renderThread.joinable()) renderThread.join();
+    }
+
+private:
+    std::thread renderThread;
+};
+
+#define TERMINAL_FRAME_HZ 60
+
+// Ticks at SIM_TICK_HZ and frames at TERMINAL_FRAME_HZ in real time. Keeps
+// track of how late the simulation wakes up so tick stability can be checked.
+class TerminalPlatform : public LinuxRenderThread {
+public:
+    TerminalPlatform() : worstLateUs(0) {}
+
+    void init() { nextTick = std::chrono::steady_clock::now(); }
+    void exit() {}
+    bool running() { return true; }
+
+    void waitForTick() {
+        nextTick += std::chrono::microseconds(1000000 / SIM_TICK_HZ);
+        std::this_thread::sleep_until(nextTick);
+
+        long long late = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - nextTick).count();
+        if (late > worstLateUs) worstLateUs = late;
+    }
+
+    void endFrame() { std::this_thread::sleep_for(std::chrono::microseconds(1000000 / TERMINAL_FRAME_HZ)); }
+    static const char* scoreLogPath() { return "pacman_scores.log"; }
+    static unsigned long long nowUs() { return LinuxTime::nowUs(); }
+
+    long long worstLateUs; // Worst delay past a tick deadline
+
+private:
+    std::chrono::steady_clock::time_point nextTick;
+};
+
+// Runs ticks back to back; the input script decides when to quit
+struct HeadlessPlatform : public LinuxRenderThread {
+    void init() {}
+    void exit() {}
+    bool running() { return true; }
+    void waitForTick() {}
+    void endFrame() { std::this_thread::yield(); }
+    static const char* scoreLogPath() { return "pacman_scores_headless.log"; }
+    static unsigned long long nowUs() { return LinuxTime::nowUs(); }
+};
+
+// ANSI terminal output: maze at the top, status and messages below it
+class TerminalRenderer {
+public:
+    void init() { printf("\x1b[2J\x1b[%d;1H\x1b[s", MESSAGE_ROW); }
+    void exit() { printf("\x1b[u\n"); }
+
+    // Pac-Man is shown on the tile nearest to its interpolated position
+    void draw(const FrameSnapshot& snapshot, int alpha) {
+        if (snapshot.state != STATE_PLAYING) return;
+        drawMaze(snapshot.maze, FrameSnapshot::nearestTile(snapshot.drawX(alpha)), FrameSnapshot::nearestTile(snapshot.drawY(alpha)));
+        printf("\x1b[%d;1HScore: %d | Time Left: %d   ", MAZE_HEIGHT + 1, snapshot.pacman.score, snapshot.remainingTime);
+        fflush(stdout);
+    }
+
+    // Messages continue from the saved cursor in the message area
+    void logLine(unsigned format, const char* text) {
+        if (format == LOG_CLEAR) printf("\x1b[%d;1H\x1b[J\x1b[s", MESSAGE_ROW);
+        else printf("\x1b[u%s\x1b[s", text);
+        fflush(stdout);
+    }
+
+private:
+    enum { MESSAGE_ROW = MAZE_HEIGHT + 3 };
+
+    void drawMaze(const Maze& maze, int pacmanX, int pacmanY) {
+        printf("\x1b[H");
+        for (int y = 0; y < MAZE_HEIGHT; y++) {
+            for (int x = 0; x < MAZE_WIDTH; x++) {
+                putchar(x == pacmanX && y == pacmanY ? 'P' : maze.cells[y][x]);
+            }
+            putchar('\n');
+        }
+    }
+};
+
+// Draws nothing; counts frames so runs can be checked, and can stand in
+// for a slow renderer by sleeping renderDelayMs per frame
+class HeadlessRenderer {
+public:
+    HeadlessRenderer() : framesDrawn(0), linesLogged(0), renderDelayMs(0) {}
+
+    void init() {}
+    void exit() {}
+
+    void draw(const FrameSnapshot&, int) {
+        framesDrawn++;
+        if (renderDelayMs) std::this_thread::sleep_for(std::chrono::milliseconds(renderDelayMs));
+    }
+
+    void logLine(unsigned, const char*) { linesLogged++; }
+
+    unsigned framesDrawn;
+    unsigned linesLogged;
+    unsigned renderDelayMs;
+};
+
+// Keyboard input: A/B/X keys, arrow keys, Enter = START, P = SELECT
+class TerminalInput {
+public:
+    TerminalInput() {
+        tcgetattr(STDIN_FILENO, &saved);
+        termios raw = saved;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        flags = fcntl(STDIN_FILENO, F_GETFL);
+        fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
+    }
+
+    ~TerminalInput() {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+        fcntl(STDIN_FILENO, F_SETFL, flags);
+    }
+
+    unsigned poll() {
+        unsigned buttons = 0;
+        char keys[16];
+        ssize_t count = read(STDIN_FILENO, keys, sizeof(keys));
+
+        for (ssize_t i = 0; i < count; i++) {
+            char key = keys[i];
+            if (key == 0x1b && i + 2 < count && keys[i + 1] == '[') {
+                static const unsigned ARROWS[4] = { BUTTON_UP, BUTTON_DOWN, BUTTON_RIGHT, BUTTON_LEFT };
+                buttons |= ARROWS[(keys[i + 2] - 'A') & 3]; // Arrow keys send ESC [ A..D
+                i += 2;
+                continue;
+            }
+            switch (key) {
+            case 'a': case 'A': buttons |= BUTTON_A; break;
+            case 'b': case 'B': buttons |= BUTTON_B; break;
+            case 'x': case 'X': buttons |= BUTTON_X; break;
+            case '\n': buttons |= BUTTON_START; break;
+            case 'p': case 'P': buttons |= BUTTON_SELECT; break;
+            }
+        }
+        return buttons;
+    }
+
+private:
+    termios saved;
+    int flags;
+};
+
+// Replays a fixed list of button presses; START is sent once the script ends
+struct ScriptedPress {
+    unsigned frame;
+    unsigned buttons;
+};
+
+class ScriptedInput {
+public:
+    ScriptedInput() : script(nullptr), count(0), next(0), frame(0) {}
+
+    void setScript(const ScriptedPress* presses, unsigned pressCount) {
+        script = presses;
+        count = pressCount;
+        next = 0;
+        frame = 0;
+    }
+
+    unsigned poll() {
+        unsigned buttons = 0;
+        while (next < count && script[next].frame <= frame) buttons |= script[next++].buttons;
+        if (next == count && (count == 0 || frame > script[count - 1].frame)) buttons |= BUTTON_START;
+        frame++;
+        return buttons;
+    }
+
+private:
+    const ScriptedPress* script;
+    unsigned count;
+    unsigned next;
+    unsigned frame;
+};
+
+// The Linux builds of the game
+typedef Game<TerminalPlatform, TerminalRenderer, TerminalInput, LinuxMillisClock> TerminalGame;
+typedef Game<HeadlessPlatform, HeadlessRenderer, ScriptedInput, FrameClock> HeadlessGame;
+typedef Game<TerminalPlatform, HeadlessRenderer, ScriptedInput, FrameClock> PacedHeadlessGame;
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef RING_LOGGER_H
+#define RING_LOGGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+// Non-blocking structured logger. The game thread only writes a small
+// binary record (format id, tick and up to LOG_MAX_ARGS arguments) into a
+// lock-free single-producer/single-consumer ring. Formatting and output
+// happen later, when the consumer calls drain() from an idle slice or a
+// background thread. If the ring is full the record is dropped and counted;
+// the game thread never waits.
+
+#define LOG_CAPACITY 256 // Records in the ring, must be a power of two
+#define LOG_MAX_ARGS 2
+#define LOG_LINE_SIZE 128
+
+enum LogFormat {
+    LOG_CLEAR,              // Clears the message area, prints nothing
+    LOG_TITLE,
+    LOG_CHOOSE_DIFFICULTY,
+    LOG_GAME_STARTED,
+    LOG_PAUSE_MENU,
+    LOG_ALL_DOTS,
+    LOG_GAME_OVER,          // score
+    LOG_HIGH_SCORE,         // difficulty name, score
+    LOG_PLAY_AGAIN,
+    LOG_SESSION_NOT_SAVED,
+    LOG_STARTUP_STEP,       // step name, microseconds since start
+    LOG_FORMAT_COUNT
+};
+
+// Format strings by LogFormat; arguments may be %d or %s (static strings only)
+static const char* const LOG_FORMATS[LOG_FORMAT_COUNT] = {
+    "",
+    "Pac-Man on 3DS\nPress A to start the game.\nPress START to exit.\n",
+    "Select Difficulty: A - Easy (4 mins), B - Medium (2.5 mins), X - Hard (2 mins)\n",
+    "Game started! Use arrows to move Pac-Man.\n",
+    "--- PAUSE MENU ---\nPress A to Resume\nPress START to Quit\n",
+    "Congratulations! All dots collected!\n",
+    "Game Over! Your score: %d\n",
+    "High score (%s): %d\n",
+    "Press A to start the game again.\n",
+    "Score log busy or unavailable, session not saved\n",
+    "Startup: %s done at %d us\n",
+};
+
+// One argument: an int, or a pointer to a string that lives forever
+union LogArg {
+    int32_t i;
+    const char* s;
+
+    LogArg() : s(nullptr) {}
+    LogArg(int value) : i(value) {}
+    LogArg(const char* text) : s(text) {}
+};
+
+struct LogRecord {
+    uint16_t format;
+    uint32_t tick;
+    LogArg args[LOG_MAX_ARGS];
+};
+
+class LogRing {
+public:
+    LogRing() : head(0), tail(0), stamp(0), droppedCount(0) {}
+
+    // Producer side: tick stamped on every following record
+    void setTick(uint32_t tick) { stamp = tick; }
+
+    // Producer side: returns false (and counts a drop) if the ring is full
+    bool write(LogFormat format, LogArg a = LogArg(), LogArg b = LogArg()) {
+        unsigned h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == LOG_CAPACITY) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        LogRecord& record = records[h & (LOG_CAPACITY - 1)];
+        record.format = format;
+        record.tick = stamp;
+        record.args[0] = a;
+        record.args[1] = b;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: format every waiting record and pass it to
+    // sink(format, tick, text). Returns the number of records drained.
+    template <class Sink>
+    unsigned drain(Sink sink) {
+        unsigned t = tail.load(std::memory_order_relaxed);
+        unsigned h = head.load(std::memory_order_acquire);
+        char line[LOG_LINE_SIZE];
+
+        for (unsigned i = t; i != h; i++) {
+            const LogRecord& record = records[i & (LOG_CAPACITY - 1)];
+            format(record, line, sizeof(line));
+            sink(record.format, record.tick, line);
+        }
+        tail.store(h, std::memory_order_release);
+        return h - t;
+    }
+
+    unsigned dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+    // Expand a record's format string; only %d, %s and %% are understood
+    static void format(const LogRecord& record, char* out, size_t size) {
+        const char* f = record.format < LOG_FORMAT_COUNT ? LOG_FORMATS[record.format] : "?\n";
+        size_t used = 0;
+        int arg = 0;
+
+        while (*f && used + 1 < size) {
+            if (f[0] == '%' && (f[1] == 'd' || f[1] == 's') && arg < LOG_MAX_ARGS) {
+                const LogArg& value = record.args[arg++];
+                int n = f[1] == 'd' ? snprintf(out + used, size - used, "%d", (int)value.i)
+                                    : snprintf(out + used, size - used, "%s", value.s ? value.s : "");
+                used += n > 0 ? (size_t)n : 0;
+                if (used >= size) used = size - 1;
+                f += 2;
+            } else {
+                if (f[0] == '%' && f[1] == '%') f++;
+                out[used++] = *f++;
+            }
+        }
+        out[used] = '\0';
+    }
+
+private:
+    LogRecord records[LOG_CAPACITY];
+    std::atomic<unsigned> head;   // Next slot the producer writes
+    std::atomic<unsigned> tail;   // Next slot the consumer reads
+    uint32_t stamp;               // Producer only
+    std::atomic<unsigned> droppedCount;
+};
+
+#endif
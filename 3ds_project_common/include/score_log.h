@@ -0,0 +1,105 @@
+#ifndef SCORE_LOG_H
+#define SCORE_LOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#ifdef __3DS__
+#include <3ds.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#define SCORE_LOG_MAGIC 0x50434C47   // "PCLG", marks the start of every record
+#define SCORE_LOG_BATCH 16           // Sessions that can wait for the writer at once
+#define SCORE_LOG_COMPACT_AT 64      // Rewrite the log on load once it grows past this
+#define SCORE_LOG_KEEP_RECENT 16     // Most recent sessions kept by compaction
+#define SCORE_LOG_KEEP_BEST 5        // Best sessions per difficulty kept by compaction
+
+// One finished game, as stored in the log
+struct SessionRecord {
+    uint8_t difficulty;     // 0 = Easy, 1 = Medium, 2 = Hard
+    uint8_t cleared;        // 1 if every pellet was eaten
+    uint16_t pelletsEaten;  // Pellets eaten this session
+    int32_t score;          // Final score
+    uint32_t clearTimeMs;   // Time played before the game ended
+};
+
+// On-disk header in front of each SessionRecord
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t length;        // Payload size in bytes
+    uint32_t crc;           // CRC-32 of the payload
+};
+
+// Append-only, checksummed log of high scores and session stats.
+// submit() only copies the record into a pending batch; a background
+// writer thread appends batches to the file so SD card I/O never runs
+// inside a frame. The writer also does the initial load: damaged records
+// (torn writes, flipped bytes) are skipped and the log is compacted to
+// drop them and keep it bounded.
+// Calls that need the saved sessions wait for that load to finish. If an
+// append fails, the partial record is cut off and submit() refuses every
+// later session this run.
+class ScoreLog {
+public:
+    explicit ScoreLog(const char* path);
+    ~ScoreLog();
+
+    void start();                            // Start the writer; it loads the log before anything else
+    bool waitLoaded();                       // Wait for the load; false if the log couldn't be read,
+                                             // a damaged log couldn't be repaired or start() wasn't called
+    bool submit(const SessionRecord& record); // Queue a session; false if it can't be saved
+    void flush();                            // Wait until every queued session is on disk
+
+    // Both wait for the load
+    int highScore(int difficulty);
+    const std::vector<SessionRecord>& sessions();
+
+private:
+    char path[128];
+    char tmpPath[132];
+    std::vector<SessionRecord> history;
+
+    SessionRecord pending[SCORE_LOG_BATCH];
+    int pendingCount;
+    int inFlight;            // Records taken by the writer but not yet on disk
+    bool writerRunning;
+    bool stopRequested;
+    bool loaded;             // The initial load has finished
+    bool loadOk;
+    bool canAppend;          // The file is safe to append to; guarded by lock once loaded
+
+#ifdef __3DS__
+    Thread writer;
+    LightLock lock;
+    LightEvent wake;
+    LightEvent drained;
+    LightEvent loadDone;
+#else
+    std::thread writer;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    std::condition_variable loadDone;
+#endif
+
+    bool readLog(bool& appendable);
+    void finishLoad(bool ok, bool appendable);
+    bool readFile(const char* file, std::vector<SessionRecord>& out, bool& damaged);
+    bool rewrite(const std::vector<SessionRecord>& records);
+    bool compact();
+    void startWriter();
+    void writerLoop();
+    bool appendBatch(const SessionRecord* batch, int count);
+
+    static uint32_t crc32(const void* data, size_t size);
+#ifdef __3DS__
+    static void writerEntry(void* arg);
+#endif
+};
+
+#endif
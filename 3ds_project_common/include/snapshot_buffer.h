@@ -0,0 +1,41 @@
+#ifndef SNAPSHOT_BUFFER_H
+#define SNAPSHOT_BUFFER_H
+
+#include <atomic>
+
+// Lock-free single-producer/single-consumer triple buffer.
+// The producer fills back() and publish()es it; the consumer consume()s
+// the newest published slot and reads front(). Neither side ever waits:
+// the producer always has a free slot and older unread snapshots are
+// simply replaced by newer ones.
+template <class T>
+class TripleBuffer {
+public:
+    TripleBuffer() : slots(), backIndex(0), frontIndex(1), middle(2) {}
+
+    // Producer side
+    T& back() { return slots[backIndex]; }
+
+    void publish() {
+        backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Consumer side: true if a newer snapshot is now in front()
+    bool consume() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    enum { INDEX_MASK = 3, FRESH = 4 }; // Middle slot index plus a "not read yet" flag
+
+    T slots[3];
+    unsigned backIndex;           // Only touched by the producer
+    unsigned frontIndex;          // Only touched by the consumer
+    std::atomic<unsigned> middle; // Slot handed between the two
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef STARTUP_PROFILE_H
+#define STARTUP_PROFILE_H
+
+#include <atomic>
+#include <cstdint>
+
+// Timestamps for each startup step, in microseconds since the profile
+// was created. Each step is marked once, from whichever thread finishes
+// it (the title is shown by the render thread).
+
+enum StartupStep {
+    STARTUP_PLATFORM,       // Graphics and platform services up
+    STARTUP_RENDERER,       // Screens the title needs are ready
+    STARTUP_BOOT_STATE,     // Boot snapshot published
+    STARTUP_RENDER_THREAD,  // Render thread started
+    STARTUP_TITLE_SHOWN,    // First frame with the title presented on screen
+    STARTUP_SCORE_LOG,      // Score log writer started; it reads saved scores itself
+    STARTUP_FIRST_TICK,     // First input polled and simulated
+    STARTUP_STEP_COUNT
+};
+
+static const char* const STARTUP_STEP_NAMES[STARTUP_STEP_COUNT] = {
+    "platform",
+    "renderer",
+    "boot state",
+    "render thread",
+    "title shown",
+    "score log",
+    "first tick",
+};
+
+class StartupProfile {
+public:
+    explicit StartupProfile(unsigned long long nowUs) : startUs(nowUs) {
+        for (int i = 0; i < STARTUP_STEP_COUNT; i++) ends[i].store(0, std::memory_order_relaxed);
+    }
+
+    void mark(StartupStep step, unsigned long long nowUs) {
+        ends[step].store((uint32_t)(nowUs - startUs) + 1, std::memory_order_relaxed);
+    }
+
+    bool reached(StartupStep step) const { return ends[step].load(std::memory_order_relaxed) != 0; }
+
+    // Microseconds from the start until step ended; 0 if it hasn't
+    uint32_t at(StartupStep step) const {
+        uint32_t end = ends[step].load(std::memory_order_relaxed);
+        return end ? end - 1 : 0;
+    }
+
+private:
+    unsigned long long startUs;
+    std::atomic<uint32_t> ends[STARTUP_STEP_COUNT]; // End time + 1, so 0 means not reached
+};
+
+#endif
@@ -0,0 +1,227 @@
+#include "actor_vm.h"
+
+#include <cstring>
+
+// Register fields and immediate of an instruction
+#define VM_A(insn) ((insn) >> 8 & 15)
+#define VM_B(insn) ((insn) >> 12 & 15)
+#define VM_C(insn) ((insn) >> 16 & 15)
+#define VM_IMM(insn) ((int32_t)(int16_t)((insn) >> 16))
+
+int VmProgram::find(const char* name) const {
+    for (int i = 0; i < scriptCount; i++) {
+        if (strncmp(scripts[i].name, name, VM_NAME_SIZE) == 0) return i;
+    }
+    return -1;
+}
+
+void VmActor::reset(const VmProgram& program, int script, uint32_t seed) {
+    memset(r, 0, sizeof(r));
+    memset(ports, 0, sizeof(ports));
+    this->seed = seed ? seed : 1;
+    pc = program.scripts[script].entry;
+    sleep = 0;
+    halted = false;
+    overruns = 0;
+}
+
+bool vmValidate(const VmProgram& program, char* error, size_t errorSize) {
+    // The instruction after the last one must be a HALT, so running off the end stops the actor
+    if (program.size >= VM_MAX_CODE || program.code[program.size] != VM_HALT) {
+        snprintf(error, errorSize, "program must end before %d instructions with a HALT after it", VM_MAX_CODE);
+        return false;
+    }
+    if (program.scriptCount > VM_MAX_SCRIPTS) {
+        snprintf(error, errorSize, "too many scripts (%u)", program.scriptCount);
+        return false;
+    }
+    for (int i = 0; i < program.scriptCount; i++) {
+        if (program.scripts[i].entry >= program.size || !memchr(program.scripts[i].name, 0, VM_NAME_SIZE)) {
+            snprintf(error, errorSize, "script %d has a bad name or entry point", i);
+            return false;
+        }
+    }
+
+    for (unsigned pc = 0; pc < program.size; pc++) {
+        uint32_t insn = program.code[pc];
+        unsigned op = insn & 0xFF;
+        int imm = VM_IMM(insn);
+        const char* problem = nullptr;
+
+        if (op >= VM_OP_COUNT) problem = "unknown opcode";
+        else if (op == VM_SLEEP && imm < 1) problem = "sleep needs at least 1 tick";
+        else if (op == VM_SHR && (imm < 0 || imm > 31)) problem = "shift out of range";
+        else if (op == VM_IN && (imm < 0 || imm >= VM_PORT_COUNT)) problem = "unknown port";
+        else if (op == VM_OUT && (imm < VM_GLOBAL_PORTS || imm >= VM_PORT_COUNT)) problem = "port is read-only";
+        else if (op >= VM_JMP && (imm < 0 || imm > program.size)) problem = "jump out of the program"; // size is the HALT
+
+        if (problem) {
+            snprintf(error, errorSize, "instruction %u: %s", pc, problem);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Dispatch uses GCC's computed goto: each handler jumps straight to the
+// next one through a table, which predicts much better than one shared
+// switch. Each dispatch also spends one unit of budget.
+unsigned vmRun(const VmProgram& program, VmActor& actor, const VmGlobals& globals, unsigned budget) {
+    static void* const HANDLERS[VM_OP_COUNT] = {
+        &&op_halt, &&op_yield, &&op_sleep, &&op_ldi, &&op_mov, &&op_add, &&op_sub, &&op_mul,
+        &&op_addi, &&op_shr, &&op_and, &&op_min, &&op_max, &&op_abs, &&op_rand, &&op_in,
+        &&op_out, &&op_jmp, &&op_jeq, &&op_jne, &&op_jlt, &&op_jle,
+    };
+
+    if (actor.halted) return 0;
+    if (actor.sleep) {
+        actor.sleep--;
+        return 0;
+    }
+
+    const uint32_t* code = program.code;
+    int32_t* r = actor.r;
+    unsigned pc = actor.pc;
+    unsigned left = budget;
+    uint32_t insn;
+
+#define DISPATCH()                          \
+    do {                                    \
+        if (!left) goto out_of_budget;      \
+        left--;                             \
+        insn = code[pc++];                  \
+        goto *HANDLERS[insn & 0xFF];        \
+    } while (0)
+
+    DISPATCH();
+
+op_halt:
+    actor.halted = true;
+    goto done;
+op_yield:
+    goto done;
+op_sleep:
+    actor.sleep = VM_IMM(insn) - 1;
+    goto done;
+op_ldi:
+    r[VM_A(insn)] = VM_IMM(insn);
+    DISPATCH();
+op_mov:
+    r[VM_A(insn)] = r[VM_B(insn)];
+    DISPATCH();
+op_add:
+    r[VM_A(insn)] = (int32_t)((uint32_t)r[VM_B(insn)] + (uint32_t)r[VM_C(insn)]);
+    DISPATCH();
+op_sub:
+    r[VM_A(insn)] = (int32_t)((uint32_t)r[VM_B(insn)] - (uint32_t)r[VM_C(insn)]);
+    DISPATCH();
+op_mul:
+    r[VM_A(insn)] = (int32_t)((uint32_t)r[VM_B(insn)] * (uint32_t)r[VM_C(insn)]);
+    DISPATCH();
+op_addi:
+    r[VM_A(insn)] = (int32_t)((uint32_t)r[VM_B(insn)] + (uint32_t)VM_IMM(insn));
+    DISPATCH();
+op_shr:
+    r[VM_A(insn)] = r[VM_B(insn)] >> VM_IMM(insn);
+    DISPATCH();
+op_and:
+    r[VM_A(insn)] = r[VM_B(insn)] & r[VM_C(insn)];
+    DISPATCH();
+op_min: {
+    int32_t b = r[VM_B(insn)], c = r[VM_C(insn)];
+    r[VM_A(insn)] = b < c ? b : c;
+    DISPATCH();
+}
+op_max: {
+    int32_t b = r[VM_B(insn)], c = r[VM_C(insn)];
+    r[VM_A(insn)] = b > c ? b : c;
+    DISPATCH();
+}
+op_abs: {
+    int32_t b = r[VM_B(insn)];
+    r[VM_A(insn)] = b < 0 ? (int32_t)(0u - (uint32_t)b) : b;
+    DISPATCH();
+}
+op_rand: {
+    // xorshift32, scaled with a multiply since the ARM11 has no divide
+    uint32_t s = actor.seed;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    actor.seed = s;
+    int32_t range = r[VM_B(insn)];
+    r[VM_A(insn)] = range > 0 ? (int32_t)((uint64_t)s * (uint32_t)range >> 32) : 0;
+    DISPATCH();
+}
+op_in: {
+    int port = VM_IMM(insn);
+    r[VM_A(insn)] = port < VM_GLOBAL_PORTS ? globals.ports[port] : actor.ports[port - VM_GLOBAL_PORTS];
+    DISPATCH();
+}
+op_out:
+    actor.ports[VM_IMM(insn) - VM_GLOBAL_PORTS] = r[VM_B(insn)];
+    DISPATCH();
+op_jmp:
+    pc = VM_IMM(insn);
+    DISPATCH();
+op_jeq:
+    if (r[VM_A(insn)] == r[VM_B(insn)]) pc = VM_IMM(insn);
+    DISPATCH();
+op_jne:
+    if (r[VM_A(insn)] != r[VM_B(insn)]) pc = VM_IMM(insn);
+    DISPATCH();
+op_jlt:
+    if (r[VM_A(insn)] < r[VM_B(insn)]) pc = VM_IMM(insn);
+    DISPATCH();
+op_jle:
+    if (r[VM_A(insn)] <= r[VM_B(insn)]) pc = VM_IMM(insn);
+    DISPATCH();
+
+#undef DISPATCH
+
+out_of_budget:
+    actor.overruns++;
+done:
+    actor.pc = pc;
+    return budget - left;
+}
+
+bool vmSave(const char* path, const VmProgram& program, char* error, size_t errorSize) {
+    if (!vmValidate(program, error, errorSize)) return false;
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        snprintf(error, errorSize, "can't write %s", path);
+        return false;
+    }
+    uint32_t magic = VM_FILE_MAGIC;
+    bool ok = fwrite(&magic, sizeof(magic), 1, f) == 1 &&
+              fwrite(&program.size, sizeof(program.size), 1, f) == 1 &&
+              fwrite(&program.scriptCount, sizeof(program.scriptCount), 1, f) == 1 &&
+              fwrite(program.scripts, sizeof(VmScript), program.scriptCount, f) == program.scriptCount &&
+              fwrite(program.code, sizeof(uint32_t), program.size, f) == program.size;
+    if (fclose(f) != 0) ok = false;
+    if (!ok) snprintf(error, errorSize, "write to %s failed", path);
+    return ok;
+}
+
+bool vmLoad(const char* path, VmProgram& program, char* error, size_t errorSize) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        snprintf(error, errorSize, "can't open %s", path);
+        return false;
+    }
+    uint32_t magic = 0;
+    bool ok = fread(&magic, sizeof(magic), 1, f) == 1 && magic == VM_FILE_MAGIC &&
+              fread(&program.size, sizeof(program.size), 1, f) == 1 && program.size < VM_MAX_CODE &&
+              fread(&program.scriptCount, sizeof(program.scriptCount), 1, f) == 1 && program.scriptCount <= VM_MAX_SCRIPTS &&
+              fread(program.scripts, sizeof(VmScript), program.scriptCount, f) == program.scriptCount &&
+              fread(program.code, sizeof(uint32_t), program.size, f) == program.size;
+    fclose(f);
+    if (!ok) {
+        snprintf(error, errorSize, "%s is not an assembled program", path);
+        return false;
+    }
+    program.code[program.size] = VM_HALT;
+    return vmValidate(program, error, errorSize);
+}
@@ -0,0 +1,496 @@
+// Linux host build of the game, using the same core as the 3DS variants.
+//
+// Build from 3ds_project_common:
+//   g++ -std=gnu++11 -O2 -Iinclude linux/*.cpp source/*.cpp -pthread -o pacman_host
+//
+// Run:
+//   ./pacman_host             play in the terminal
+//   ./pacman_host --headless [LOGFILE]
+//                             replay a scripted session with no output,
+//                             optionally writing the message log to LOGFILE
+//   ./pacman_host --render-delay MS
+//                             play 3 seconds in real time with a renderer that
+//                             takes MS per frame; fail if a tick is skipped or starts
+//                             more than LATE_BUDGET_US late
+//   ./pacman_host --bench-log compare the game thread's cost per message for
+//                             the ring logger and for a direct printf
+//   ./pacman_host --check-score-log
+//                             cut and corrupt the score log at every byte and check
+//                             what loading recovers, then time submit() while the
+//                             writer is busy
+//   ./pacman_host --check-interpolation
+//                             check that interpolated rendering shows Pac-Man on
+//                             the same tiles, in the same order, as the simulation
+//   ./pacman_host --startup   print how long each startup step took and fail if
+//                             the title isn't up within STARTUP_BUDGET_US
+//   ./pacman_host --assemble SOURCE OUTPUT
+//                             assemble actor scripts into a program file
+//   ./pacman_host --bench-vm [ACTORS] [SOURCE]
+//                             run ACTORS scripted actors (default 512) from SOURCE
+//                             (default levels/level1.avs) and report VM throughput
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <vector>
+#include <string>
+#include "policies_linux.h"
+#include "vm_assembler.h"
+
+// Easy difficulty, then a route along the corridors until the timer runs out
+static const ScriptedPress DEMO_SCRIPT[] = {
+    { 1, BUTTON_A },
+    { 2, BUTTON_A },
+    { 3, BUTTON_RIGHT },
+    { 60, BUTTON_UP },
+    { 120, BUTTON_RIGHT },
+    { 300, BUTTON_DOWN },
+    { 350, BUTTON_LEFT },
+    { 450, BUTTON_UP },
+    { 500, BUTTON_RIGHT },
+    { 7500, 0 },
+};
+
+static int runHeadless(const char* logPath) {
+    FILE* logFile = logPath ? fopen(logPath, "w") : nullptr;
+
+    HeadlessGame game;
+    game.setLogFile(logFile);
+    game.inputPolicy().setScript(DEMO_SCRIPT, sizeof(DEMO_SCRIPT) / sizeof(DEMO_SCRIPT[0]));
+    game.run();
+    if (logFile) fclose(logFile);
+
+    printf("frames drawn: %u, lines logged: %u\n", game.rendererPolicy().framesDrawn, game.rendererPolicy().linesLogged);
+    printf("final score: %d, pellets eaten: %d\n", game.player().score, game.player().pelletsEaten);
+    return 0;
+}
+
+static const ScriptedPress PACED_SCRIPT[] = {
+    { 1, BUTTON_A },
+    { 2, BUTTON_A },
+    { 3, BUTTON_RIGHT },
+    { 3 * SIM_TICK_HZ, 0 },
+};
+
+#define PACED_TICKS (3 * SIM_TICK_HZ + 2) // The script's last press, plus the ticks that read the title and menu
+#define LATE_BUDGET_US (1000000 / SIM_TICK_HZ / 2) // Half a tick; later than that and the game visibly stutters
+
+// However slow the renderer, the simulation must run every tick and none
+// of them may start more than LATE_BUDGET_US after its deadline
+static int runWithRenderDelay(unsigned delayMs) {
+    PacedHeadlessGame game;
+    game.rendererPolicy().renderDelayMs = delayMs;
+    game.inputPolicy().setScript(PACED_SCRIPT, sizeof(PACED_SCRIPT) / sizeof(PACED_SCRIPT[0]));
+    game.run();
+
+    bool allTicks = game.ticks() == PACED_TICKS;
+    bool onTime = game.platformPolicy().worstLateUs <= LATE_BUDGET_US;
+    printf("render delay: %u ms\n", delayMs);
+    printf("simulation ticks: %u, expected %d: %s\n", game.ticks(), PACED_TICKS, allTicks ? "ok" : "FAILED");
+    printf("frames drawn: %u\n", game.rendererPolicy().framesDrawn);
+    printf("worst tick lateness: %lld us, budget %d us: %s\n", game.platformPolicy().worstLateUs, LATE_BUDGET_US,
+           onTime ? "ok" : "FAILED");
+    return allTicks && onTime ? 0 : 1;
+}
+
+#define BENCH_FRAMES 2000
+#define BENCH_MESSAGES_PER_FRAME 16
+
+static double nsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Each "frame" the game thread sends a burst of messages; a consumer
+// thread drains the ring into /dev/null once per millisecond
+static int benchLog() {
+    FILE* sink = fopen("/dev/null", "w");
+    setvbuf(sink, nullptr, _IOLBF, 0); // Line by line, like a console
+    static LogRing ring;
+    std::atomic<bool> done(false);
+
+    std::thread consumer([&] {
+        while (!done.load()) {
+            ring.drain([sink](unsigned, unsigned, const char* text) { fputs(text, sink); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    double ringTotal = 0, ringWorst = 0;
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BENCH_MESSAGES_PER_FRAME; i++) ring.write(LOG_HIGH_SCORE, "Easy", frame * 10 + i);
+        double ns = nsSince(start) / BENCH_MESSAGES_PER_FRAME;
+        ringTotal += ns;
+        if (ns > ringWorst) ringWorst = ns;
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    done.store(true);
+    consumer.join();
+
+    double printfTotal = 0, printfWorst = 0;
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BENCH_MESSAGES_PER_FRAME; i++) fprintf(sink, "High score (%s): %d\n", "Easy", frame * 10 + i);
+        double ns = nsSince(start) / BENCH_MESSAGES_PER_FRAME;
+        printfTotal += ns;
+        if (ns > printfWorst) printfWorst = ns;
+    }
+    fclose(sink);
+
+    printf("%d frames x %d messages\n", BENCH_FRAMES, BENCH_MESSAGES_PER_FRAME);
+    printf("ring logger:   %.1f ns/call average, %.1f ns/call worst frame, %u dropped\n",
+           ringTotal / BENCH_FRAMES, ringWorst, ring.dropped());
+    printf("direct printf: %.1f ns/call average, %.1f ns/call worst frame\n", printfTotal / BENCH_FRAMES, printfWorst);
+    return 0;
+}
+
+// Directions fed to every difficulty in --check-interpolation, by tick
+static const ScriptedPress ROUTE[] = {
+    { 3, BUTTON_RIGHT },
+    { 40, BUTTON_UP },
+    { 80, BUTTON_RIGHT },
+    { 160, BUTTON_DOWN },
+    { 200, BUTTON_LEFT },
+    { 260, BUTTON_UP },
+    { 300, BUTTON_RIGHT },
+    { 360, BUTTON_DOWN },
+    { 420, BUTTON_LEFT },
+};
+
+#define CHECK_TICKS 600
+
+struct Tile {
+    int x, y;
+    bool operator!=(const Tile& other) const { return x != other.x || y != other.y; }
+};
+
+// Append tile unless Pac-Man is still on the last one recorded
+static void visit(std::vector<Tile>& path, Tile tile) {
+    if (path.empty() || path.back() != tile) path.push_back(tile);
+}
+
+static bool samePath(const std::vector<Tile>& a, const std::vector<Tile>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+// Every step in path goes to an open, 4-neighbouring tile
+static bool walkable(const std::vector<Tile>& path, const Maze& maze) {
+    for (size_t i = 0; i < path.size(); i++) {
+        if (maze.isWall(path[i].x, path[i].y)) return false;
+        if (i && abs(path[i].x - path[i - 1].x) + abs(path[i].y - path[i - 1].y) != 1) return false;
+    }
+    return true;
+}
+
+// Drive the simulation tick by tick and compare the tiles it visits with
+// the tiles a renderer would show for the same snapshots, both without
+// interpolation and at several points between ticks
+static int checkInterpolation() {
+    static const int ALPHAS[] = { 0, ALPHA_ONE / 4, ALPHA_ONE / 2, ALPHA_ONE * 3 / 4, ALPHA_ONE };
+    static const int ALPHA_COUNT = sizeof(ALPHAS) / sizeof(ALPHAS[0]);
+    FrameSnapshot snapshot; // About 1 KB with the maze
+    bool ok = true;
+
+    for (int d = 0; d < DIFFICULTY_COUNT; d++) {
+        HeadlessGame game;
+        std::vector<Tile> simulated, rendered[ALPHA_COUNT];
+        Maze walls;
+        walls.reset();
+        size_t next = 0;
+
+        for (unsigned tick = 1; tick <= CHECK_TICKS; tick++) {
+            unsigned buttons = tick == 1 ? (unsigned)BUTTON_A : tick == 2 ? DIFFICULTIES[d].button : 0;
+            if (next < sizeof(ROUTE) / sizeof(ROUTE[0]) && ROUTE[next].frame == tick) buttons |= ROUTE[next++].buttons;
+
+            game.update(buttons);
+            game.takeSnapshot(snapshot);
+            if (snapshot.state != STATE_PLAYING) continue;
+
+            Tile tile = { snapshot.pacman.x, snapshot.pacman.y };
+            visit(simulated, tile);
+            for (int a = 0; a < ALPHA_COUNT; a++) {
+                Tile shown = { FrameSnapshot::nearestTile(snapshot.drawX(ALPHAS[a])),
+                               FrameSnapshot::nearestTile(snapshot.drawY(ALPHAS[a])) };
+                visit(rendered[a], shown);
+            }
+        }
+
+        bool pathOk = walkable(simulated, walls);
+        for (int a = 0; a < ALPHA_COUNT; a++) pathOk = pathOk && samePath(simulated, rendered[a]);
+        ok = ok && pathOk;
+
+        printf("%-6s speed %3d/%d per tick: %zu tiles visited, score %d, rendered paths %s\n",
+               DIFFICULTIES[d].name, DIFFICULTIES[d].speed, SUBTILE_UNITS, simulated.size(),
+               game.player().score, pathOk ? "match" : "DIFFER");
+    }
+    printf(ok ? "interpolation check passed\n" : "interpolation check FAILED\n");
+    return ok ? 0 : 1;
+}
+
+// Title shown and first tick simulated. The title only counts once its
+// frame has been presented, so the budget includes one frame's wait.
+#define STARTUP_BUDGET_US (20000 + 1000000 / TERMINAL_FRAME_HZ)
+
+static const ScriptedPress IDLE_SCRIPT[] = {
+    { SIM_TICK_HZ / 2, 0 },
+};
+
+// Start the game with the headless renderer, sit on the title for half a
+// second and report the startup steps in the order they finished
+static int checkStartup() {
+    PacedHeadlessGame game;
+    game.inputPolicy().setScript(IDLE_SCRIPT, sizeof(IDLE_SCRIPT) / sizeof(IDLE_SCRIPT[0]));
+    game.run();
+
+    const StartupProfile& profile = game.startupProfile();
+    bool done[STARTUP_STEP_COUNT] = {};
+    uint32_t previous = 0;
+    printf("%-14s %10s %10s\n", "step", "took us", "at us");
+    for (int n = 0; n < STARTUP_STEP_COUNT; n++) {
+        int next = -1;
+        for (int i = 0; i < STARTUP_STEP_COUNT; i++) {
+            if (done[i] || !profile.reached((StartupStep)i)) continue;
+            if (next < 0 || profile.at((StartupStep)i) < profile.at((StartupStep)next)) next = i;
+        }
+        if (next < 0) break;
+        done[next] = true;
+
+        uint32_t at = profile.at((StartupStep)next);
+        printf("%-14s %10u %10u\n", STARTUP_STEP_NAMES[next], at - previous, at);
+        previous = at;
+    }
+
+    bool ok = true;
+    for (int i = 0; i < STARTUP_STEP_COUNT; i++) {
+        if (!profile.reached((StartupStep)i)) {
+            printf("%s never finished\n", STARTUP_STEP_NAMES[i]);
+            ok = false;
+        }
+    }
+    uint32_t interactive = std::max(profile.at(STARTUP_TITLE_SHOWN), profile.at(STARTUP_FIRST_TICK));
+    ok = ok && interactive <= STARTUP_BUDGET_US;
+    printf("interactive title after %u us, budget %d us: %s\n", interactive, STARTUP_BUDGET_US, ok ? "ok" : "OVER BUDGET");
+    return ok ? 0 : 1;
+}
+
+static int assemble(const char* source, const char* output) {
+    static VmProgram program; // 16 KB of code, keep it off the stack
+    char error[128];
+    if (!vmAssembleFile(source, program, error, sizeof(error)) || !vmSave(output, program, error, sizeof(error))) {
+        fprintf(stderr, "%s: %s\n", source, error);
+        return 1;
+    }
+    printf("%s: %u instructions, %u scripts\n", output, program.size, program.scriptCount);
+    return 0;
+}
+
+#define BENCH_VM_TICKS 3000 // 100 seconds of play
+
+// Never yields; shows that the budget caps what one bad script can cost
+static const char RUNAWAY_SOURCE[] =
+    "script runaway\n"
+    "spin:\n"
+    "    addi r0, r0, 1\n"
+    "    jmp  spin\n";
+
+static int benchVm(int actorCount, const char* sourcePath) {
+    static VmProgram program, runaway;
+    char error[128];
+    if (!vmAssembleFile(sourcePath, program, error, sizeof(error)) ||
+        !vmAssemble(RUNAWAY_SOURCE, runaway, error, sizeof(error))) {
+        fprintf(stderr, "%s\n", error);
+        return 1;
+    }
+
+    // Every script in the file gets an equal share of the actors, plus one runaway
+    std::vector<VmActor> actors(actorCount + 1);
+    for (int i = 0; i < actorCount; i++) {
+        actors[i].reset(program, i % program.scriptCount, 2654435761u * (i + 1));
+        actors[i].setPort(VM_PORT_SELF_X, i % MAZE_WIDTH);
+        actors[i].setPort(VM_PORT_SELF_Y, i % MAZE_HEIGHT);
+    }
+    actors[actorCount].reset(runaway, 0, 1);
+
+    VmGlobals globals;
+    unsigned long long instructions = 0;
+    double totalNs = 0, worstNs = 0;
+    for (int tick = 0; tick < BENCH_VM_TICKS; tick++) {
+        // A player sweeping the corridors and eating as it goes
+        globals.ports[VM_PORT_TICK] = tick;
+        globals.ports[VM_PORT_PLAYER_X] = 1 + tick / 4 % (MAZE_WIDTH - 2);
+        globals.ports[VM_PORT_PLAYER_Y] = 1 + tick / 200 % (MAZE_HEIGHT - 2);
+        globals.ports[VM_PORT_PLAYER_DX] = 1;
+        globals.ports[VM_PORT_PLAYER_DY] = 0;
+        globals.ports[VM_PORT_PELLETS] = MAZE_PELLETS - tick * MAZE_PELLETS / BENCH_VM_TICKS;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < actorCount; i++) instructions += vmRun(program, actors[i], globals, VM_TICK_BUDGET);
+        instructions += vmRun(runaway, actors[actorCount], globals, VM_TICK_BUDGET);
+        double ns = nsSince(start);
+        totalNs += ns;
+        if (ns > worstNs) worstNs = ns;
+    }
+
+    unsigned overruns = 0;
+    for (int i = 0; i < actorCount; i++) overruns += actors[i].overruns;
+
+    printf("%d actors over %u scripts + 1 runaway, %d ticks, budget %d instructions/actor/tick\n",
+           actorCount, program.scriptCount, BENCH_VM_TICKS, VM_TICK_BUDGET);
+    printf("instructions: %llu (%.1f per actor per tick)\n", instructions,
+           (double)instructions / BENCH_VM_TICKS / (actorCount + 1));
+    printf("throughput: %.1f M instructions/s, %.2f ns/instruction\n", instructions / totalNs * 1000.0, totalNs / instructions);
+    printf("per tick: %.1f us average, %.1f us worst (tick is %d us)\n",
+           totalNs / BENCH_VM_TICKS / 1000.0, worstNs / 1000.0, 1000000 / SIM_TICK_HZ);
+    printf("budget overruns: %u from level scripts, %u from the runaway\n", overruns, actors[actorCount].overruns);
+    return 0;
+}
+
+#define CHECK_LOG_PATH "pacman_scores_check.log"
+#define CHECK_LOG_RECORDS 5
+#define SUBMIT_ROUNDS 500
+#define SUBMIT_BUDGET_US 1000 // Worst submit() allowed; a tick is 33 ms
+
+static SessionRecord checkRecord(int i) {
+    SessionRecord record;
+    memset(&record, 0, sizeof(record));
+    record.difficulty = i % DIFFICULTY_COUNT;
+    record.pelletsEaten = i;
+    record.score = 100 * (i + 1);
+    record.clearTimeMs = 1000 * i;
+    return record;
+}
+
+static void writeFile(const char* path, const std::string& bytes) {
+    FILE* f = fopen(path, "wb");
+    fwrite(bytes.data(), 1, bytes.size(), f);
+    fclose(f);
+}
+
+static std::string readWholeFile(const char* path) {
+    std::string bytes;
+    FILE* f = fopen(path, "rb");
+    if (!f) return bytes;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) bytes.append(buffer, n);
+    fclose(f);
+    return bytes;
+}
+
+// True if the log at CHECK_LOG_PATH loads as exactly the first `kept` check
+// records minus record `lost` (-1 for none), and a session saved afterwards
+// is read back after them
+static bool recovers(int kept, int lost) {
+    std::vector<SessionRecord> expected;
+    for (int i = 0; i < kept; i++) {
+        if (i != lost) expected.push_back(checkRecord(i));
+    }
+
+    {
+        ScoreLog log(CHECK_LOG_PATH);
+        log.start();
+        const std::vector<SessionRecord>& sessions = log.sessions();
+        if (sessions.size() != expected.size()) return false;
+        for (size_t i = 0; i < expected.size(); i++) {
+            if (memcmp(&sessions[i], &expected[i], sizeof(SessionRecord)) != 0) return false;
+        }
+        SessionRecord extra = checkRecord(CHECK_LOG_RECORDS);
+        if (!log.submit(extra)) return false;
+    }
+
+    ScoreLog reloaded(CHECK_LOG_PATH);
+    reloaded.start();
+    const std::vector<SessionRecord>& sessions = reloaded.sessions();
+    SessionRecord extra = checkRecord(CHECK_LOG_RECORDS);
+    return sessions.size() == expected.size() + 1 && memcmp(&sessions.back(), &extra, sizeof(SessionRecord)) == 0;
+}
+
+static int checkScoreLog() {
+    remove(CHECK_LOG_PATH);
+    {
+        ScoreLog log(CHECK_LOG_PATH);
+        log.start();
+        for (int i = 0; i < CHECK_LOG_RECORDS; i++) log.submit(checkRecord(i));
+    }
+    std::string clean = readWholeFile(CHECK_LOG_PATH);
+    size_t recordSize = sizeof(RecordHeader) + sizeof(SessionRecord);
+    if (clean.size() != CHECK_LOG_RECORDS * recordSize) {
+        printf("log is %zu bytes, expected %zu\n", clean.size(), CHECK_LOG_RECORDS * recordSize);
+        return 1;
+    }
+
+    // A write torn at any byte keeps every record before it
+    int failures = 0;
+    for (size_t cut = 0; cut < clean.size(); cut++) {
+        writeFile(CHECK_LOG_PATH, clean.substr(0, cut));
+        if (!recovers(cut / recordSize, -1)) {
+            printf("torn at byte %zu: wrong sessions recovered\n", cut);
+            failures++;
+        }
+    }
+    printf("torn writes: %zu offsets checked\n", clean.size());
+
+    // A damaged byte anywhere costs only the record it is in
+    for (size_t at = 0; at < clean.size(); at++) {
+        std::string damaged = clean;
+        damaged[at] ^= 0xFF;
+        writeFile(CHECK_LOG_PATH, damaged);
+        if (!recovers(CHECK_LOG_RECORDS, at / recordSize)) {
+            printf("corrupt byte %zu: wrong sessions recovered\n", at);
+            failures++;
+        }
+    }
+    printf("corrupt bytes: %zu offsets checked\n", clean.size());
+
+    // Sessions arrive in bursts while the writer is still syncing the last batch
+    remove(CHECK_LOG_PATH);
+    double worstNs = 0, totalNs = 0;
+    int refused = 0;
+    {
+        ScoreLog log(CHECK_LOG_PATH);
+        log.start();
+        log.waitLoaded();
+        for (int round = 0; round < SUBMIT_ROUNDS; round++) {
+            for (int i = 0; i < 4; i++) {
+                auto start = std::chrono::steady_clock::now();
+                if (!log.submit(checkRecord(i))) refused++;
+                double ns = nsSince(start);
+                totalNs += ns;
+                if (ns > worstNs) worstNs = ns;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    remove(CHECK_LOG_PATH);
+    remove(CHECK_LOG_PATH ".tmp");
+
+    bool fastEnough = worstNs <= SUBMIT_BUDGET_US * 1000.0;
+    printf("submit while writing: %.0f ns average, %.0f ns worst (budget %d us), %d of %d refused as queue full\n",
+           totalNs / (SUBMIT_ROUNDS * 4), worstNs, SUBMIT_BUDGET_US, refused, SUBMIT_ROUNDS * 4);
+    if (!fastEnough) failures++;
+
+    printf(failures ? "score log check FAILED (%d)\n" : "score log check passed\n", failures);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0) return runHeadless(argc > 2 ? argv[2] : nullptr);
+    if (argc > 1 && strcmp(argv[1], "--bench-log") == 0) return benchLog();
+    if (argc > 1 && strcmp(argv[1], "--check-score-log") == 0) return checkScoreLog();
+    if (argc > 1 && strcmp(argv[1], "--check-interpolation") == 0) return checkInterpolation();
+    if (argc > 1 && strcmp(argv[1], "--startup") == 0) return checkStartup();
+    if (argc > 3 && strcmp(argv[1], "--assemble") == 0) return assemble(argv[2], argv[3]);
+    if (argc > 1 && strcmp(argv[1], "--bench-vm") == 0) {
+        return benchVm(argc > 2 ? atoi(argv[2]) : 512, argc > 3 ? argv[3] : "levels/level1.avs");
+    }
+    if (argc > 2 && strcmp(argv[1], "--render-delay") == 0) return runWithRenderDelay(atoi(argv[2]));
+
+    TerminalGame game;
+    game.run();
+    return 0;
+}
@@ -0,0 +1,244 @@
+#include "vm_assembler.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// Operand shapes: r = register, i = immediate, p = port, l = label
+struct Mnemonic {
+    const char* name;
+    VmOp op;
+    const char* operands;
+};
+
+static const Mnemonic MNEMONICS[] = {
+    { "halt", VM_HALT, "" },
+    { "yield", VM_YIELD, "" },
+    { "sleep", VM_SLEEP, "i" },
+    { "ldi", VM_LDI, "ri" },
+    { "mov", VM_MOV, "rr" },
+    { "add", VM_ADD, "rrr" },
+    { "sub", VM_SUB, "rrr" },
+    { "mul", VM_MUL, "rrr" },
+    { "addi", VM_ADDI, "rri" },
+    { "shr", VM_SHR, "rri" },
+    { "and", VM_AND, "rrr" },
+    { "min", VM_MIN, "rrr" },
+    { "max", VM_MAX, "rrr" },
+    { "abs", VM_ABS, "rr" },
+    { "rand", VM_RAND, "rr" },
+    { "in", VM_IN, "rp" },
+    { "out", VM_OUT, "pr" },
+    { "jmp", VM_JMP, "l" },
+    { "jeq", VM_JEQ, "rrl" },
+    { "jne", VM_JNE, "rrl" },
+    { "jlt", VM_JLT, "rrl" },
+    { "jle", VM_JLE, "rrl" },
+};
+
+// A jump whose label is resolved once the whole file has been read
+struct Fixup {
+    unsigned pc;
+    std::string label;
+    int line;
+};
+
+class Assembler {
+public:
+    Assembler(VmProgram& program, char* error, size_t errorSize)
+        : program(program), error(error), errorSize(errorSize), line(0) {}
+
+    bool run(const char* source) {
+        memset(&program, 0, sizeof(program));
+
+        while (*source) {
+            const char* end = strchr(source, '\n');
+            size_t length = end ? (size_t)(end - source) : strlen(source);
+            line++;
+            if (!parseLine(std::string(source, length))) return false;
+            source += length + (end ? 1 : 0);
+        }
+
+        for (size_t i = 0; i < fixups.size(); i++) {
+            std::map<std::string, int>::const_iterator label = labels.find(fixups[i].label);
+            if (label == labels.end()) {
+                line = fixups[i].line;
+                return fail("unknown label '%s'", fixups[i].label.c_str());
+            }
+            program.code[fixups[i].pc] |= (uint32_t)label->second << 16;
+        }
+        program.code[program.size] = VM_HALT;
+        return vmValidate(program, error, errorSize);
+    }
+
+private:
+    VmProgram& program;
+    char* error;
+    size_t errorSize;
+    int line;
+    std::map<std::string, int> labels;
+    std::map<std::string, int> constants;
+    std::vector<Fixup> fixups;
+
+    bool fail(const char* format, const char* detail = "") {
+        int n = snprintf(error, errorSize, "line %d: ", line);
+        if (n >= 0 && (size_t)n < errorSize) snprintf(error + n, errorSize - n, format, detail);
+        return false;
+    }
+
+    // Split on whitespace and commas, dropping comments
+    static std::vector<std::string> tokenize(const std::string& text) {
+        std::vector<std::string> tokens;
+        std::string token;
+        for (size_t i = 0; i <= text.size(); i++) {
+            char c = i < text.size() ? text[i] : ' ';
+            if (c == ';' || c == '#') c = ' ', i = text.size();
+            if (isspace((unsigned char)c) || c == ',') {
+                if (!token.empty()) tokens.push_back(token);
+                token.clear();
+            } else {
+                token += (char)tolower((unsigned char)c);
+            }
+        }
+        return tokens;
+    }
+
+    bool parseLine(const std::string& text) {
+        std::vector<std::string> tokens = tokenize(text);
+        size_t first = 0;
+
+        // Leading "label:"
+        if (!tokens.empty() && tokens[0][tokens[0].size() - 1] == ':') {
+            std::string name = tokens[0].substr(0, tokens[0].size() - 1);
+            if (!defineLabel(name)) return false;
+            first = 1;
+        }
+        if (first == tokens.size()) return true;
+
+        const std::string& word = tokens[first];
+        std::vector<std::string> args(tokens.begin() + first + 1, tokens.end());
+
+        if (word == "script") {
+            if (args.size() != 1) return fail("script needs a name");
+            if (args[0].size() >= VM_NAME_SIZE) return fail("script name '%s' is too long", args[0].c_str());
+            if (program.scriptCount == VM_MAX_SCRIPTS) return fail("too many scripts");
+            if (!defineLabel(args[0])) return false;
+            VmScript& script = program.scripts[program.scriptCount++];
+            snprintf(script.name, sizeof(script.name), "%s", args[0].c_str());
+            script.entry = program.size;
+            return true;
+        }
+        if (word == "const") {
+            int value;
+            if (args.size() != 2) return fail("const needs a name and a value");
+            if (!number(args[1], value)) return false;
+            constants[args[0]] = value;
+            return true;
+        }
+        return instruction(word, args);
+    }
+
+    bool defineLabel(const std::string& name) {
+        if (name.empty() || labels.count(name)) return fail("label '%s' is empty or defined twice", name.c_str());
+        labels[name] = program.size;
+        return true;
+    }
+
+    bool instruction(const std::string& word, const std::vector<std::string>& args) {
+        const Mnemonic* m = nullptr;
+        for (size_t i = 0; i < sizeof(MNEMONICS) / sizeof(MNEMONICS[0]); i++) {
+            if (word == MNEMONICS[i].name) m = &MNEMONICS[i];
+        }
+        if (!m) return fail("unknown instruction '%s'", word.c_str());
+        if (args.size() != strlen(m->operands)) return fail("wrong number of operands for '%s'", word.c_str());
+        if (program.size + 1 >= VM_MAX_CODE) return fail("program too long");
+
+        unsigned regs[3] = { 0, 0, 0 };
+        unsigned regCount = 0;
+        int imm = 0;
+        for (size_t i = 0; i < args.size(); i++) {
+            switch (m->operands[i]) {
+            case 'r':
+                if (!reg(args[i], regs[regCount++])) return false;
+                break;
+            case 'i':
+                if (!number(args[i], imm)) return false;
+                break;
+            case 'p':
+                if (!port(args[i], imm)) return false;
+                break;
+            case 'l': {
+                Fixup fixup = { program.size, args[i], line };
+                fixups.push_back(fixup);
+                break;
+            }
+            }
+        }
+
+        // Same checks as vmValidate, made here so the error has a line number
+        if (m->op == VM_SLEEP && imm < 1) return fail("sleep needs at least 1 tick");
+        if (m->op == VM_SHR && (imm < 0 || imm > 31)) return fail("shift %s is out of range 0-31", args[2].c_str());
+        if (m->op == VM_OUT && imm < VM_GLOBAL_PORTS) return fail("port '%s' is read-only", args[0].c_str());
+
+        // OUT writes register b; everything else fills a, b, c in order
+        if (m->op == VM_OUT) regs[1] = regs[0], regs[0] = 0;
+        bool hasImm = strchr(m->operands, 'i') || strchr(m->operands, 'p') || strchr(m->operands, 'l');
+        program.code[program.size++] = hasImm ? vmEncodeImm(m->op, regs[0], regs[1], imm)
+                                              : vmEncode(m->op, regs[0], regs[1], regs[2]);
+        return true;
+    }
+
+    bool reg(const std::string& text, unsigned& out) {
+        char* end;
+        long n = text.size() > 1 && text[0] == 'r' ? strtol(text.c_str() + 1, &end, 10) : -1;
+        if (n < 0 || n >= VM_REGISTERS || *end) return fail("'%s' is not a register r0-r15", text.c_str());
+        out = (unsigned)n;
+        return true;
+    }
+
+    bool number(const std::string& text, int& out) {
+        std::map<std::string, int>::const_iterator constant = constants.find(text);
+        if (constant != constants.end()) {
+            out = constant->second;
+            return true;
+        }
+        char* end;
+        long n = strtol(text.c_str(), &end, 0);
+        if (text.empty() || *end) return fail("'%s' is not a number or constant", text.c_str());
+        if (n < -32768 || n > 32767) return fail("%s doesn't fit in 16 bits", text.c_str());
+        out = (int)n;
+        return true;
+    }
+
+    bool port(const std::string& text, int& out) {
+        for (int i = 0; i < VM_PORT_COUNT; i++) {
+            if (text == VM_PORT_NAMES[i]) {
+                out = i;
+                return true;
+            }
+        }
+        return fail("unknown port '%s'", text.c_str());
+    }
+};
+
+bool vmAssemble(const char* source, VmProgram& program, char* error, size_t errorSize) {
+    Assembler assembler(program, error, errorSize);
+    return assembler.run(source);
+}
+
+bool vmAssembleFile(const char* path, VmProgram& program, char* error, size_t errorSize) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        snprintf(error, errorSize, "can't open %s", path);
+        return false;
+    }
+    std::string source;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) source.append(buffer, n);
+    fclose(f);
+    return vmAssemble(source.c_str(), program, error, errorSize);
+}
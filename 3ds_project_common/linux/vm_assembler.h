@@ -0,0 +1,24 @@
+#ifndef VM_ASSEMBLER_H
+#define VM_ASSEMBLER_H
+
+#include "actor_vm.h"
+
+// Host-side assembler for actor scripts. One source file holds all the
+// scripts of a level:
+//
+//   ; comment
+//   const SCATTER 1          named constant, usable wherever a number is
+//   script chaser            entry point other code can start an actor at
+//   loop:                    label for jumps
+//       in   r0, player_x    register, port name
+//       out  target_x, r0
+//       addi r1, r1, -1
+//       jlt  r1, r2, loop
+//       yield
+//
+// Mnemonics and operands are as listed in VmOp. The assembled program is
+// validated before it is returned.
+bool vmAssemble(const char* source, VmProgram& program, char* error, size_t errorSize);
+bool vmAssembleFile(const char* path, VmProgram& program, char* error, size_t errorSize);
+
+#endif
@@ -0,0 +1,378 @@
+#include "score_log.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <unistd.h> // For fsync and ftruncate
+
+#define WRITER_STACK_SIZE (16 * 1024) // Stack for the 3DS writer thread
+
+ScoreLog::ScoreLog(const char* path)
+    : pendingCount(0), inFlight(0), writerRunning(false), stopRequested(false), loaded(false), loadOk(false),
+      canAppend(false) {
+    snprintf(this->path, sizeof(this->path), "%s", path);
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+#ifdef __3DS__
+    writer = nullptr;
+    LightLock_Init(&lock);
+    LightEvent_Init(&wake, RESET_ONESHOT);
+    LightEvent_Init(&drained, RESET_ONESHOT);
+    LightEvent_Init(&loadDone, RESET_STICKY);
+#endif
+}
+
+ScoreLog::~ScoreLog() {
+    if (!writerRunning) return;
+
+    // Ask the writer to finish the last batch and exit
+#ifdef __3DS__
+    LightLock_Lock(&lock);
+    stopRequested = true;
+    LightLock_Unlock(&lock);
+    LightEvent_Signal(&wake);
+    threadJoin(writer, U64_MAX);
+    threadFree(writer);
+#else
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopRequested = true;
+    }
+    wake.notify_one();
+    writer.join();
+#endif
+}
+
+void ScoreLog::start() {
+    startWriter();
+    if (writerRunning) return;
+
+    // No thread to spare: load here, and sessions won't be saved
+    bool appendable;
+    bool ok = readLog(appendable);
+    finishLoad(ok, false);
+}
+
+// Read the log (recovering from an interrupted compaction), skip damaged
+// records and compact it if needed. Runs on the writer thread before it
+// takes any batches. appendable is false if damage couldn't be cut out.
+bool ScoreLog::readLog(bool& appendable) {
+    history.clear();
+
+    FILE* probe = fopen(path, "rb");
+    if (probe) {
+        fclose(probe);
+        remove(tmpPath); // A leftover temp file is an unfinished compaction
+    } else {
+        probe = fopen(tmpPath, "rb");
+        if (probe) {
+            // The old log was removed after the temp file was complete
+            fclose(probe);
+            rename(tmpPath, path);
+        }
+    }
+
+    bool damaged = false;
+    bool ok = readFile(path, history, damaged);
+    bool compacted = (damaged || history.size() > SCORE_LOG_COMPACT_AT) && compact();
+
+    // Leave room so submit() doesn't reallocate during play
+    history.reserve(history.size() + SCORE_LOG_COMPACT_AT);
+
+    // Without a clean rewrite the damage would stay in the file under every
+    // later record, so nothing more is saved this run
+    appendable = !damaged || compacted;
+    return ok && appendable;
+}
+
+// Publish the load's result; history belongs to the game thread from here on
+void ScoreLog::finishLoad(bool ok, bool appendable) {
+#ifdef __3DS__
+    LightLock_Lock(&lock);
+    loaded = true;
+    loadOk = ok;
+    canAppend = appendable;
+    LightLock_Unlock(&lock);
+    LightEvent_Signal(&loadDone);
+#else
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        loaded = true;
+        loadOk = ok;
+        canAppend = appendable;
+    }
+    loadDone.notify_all();
+#endif
+}
+
+bool ScoreLog::waitLoaded() {
+#ifdef __3DS__
+    LightLock_Lock(&lock);
+    bool waitable = loaded || writerRunning;
+    LightLock_Unlock(&lock);
+    if (!waitable) return false;
+    LightEvent_Wait(&loadDone);
+    return loadOk;
+#else
+    std::unique_lock<std::mutex> guard(lock);
+    if (!loaded && !writerRunning) return false;
+    loadDone.wait(guard, [this] { return loaded; });
+    return loadOk;
+#endif
+}
+
+// Called from the game loop: copies the record and wakes the writer.
+// False if the session can't be saved.
+bool ScoreLog::submit(const SessionRecord& record) {
+    waitLoaded();
+    bool queued = false;
+#ifdef __3DS__
+    LightLock_Lock(&lock);
+#else
+    std::unique_lock<std::mutex> guard(lock);
+#endif
+    // canAppend is false if the log wasn't started or repaired, or a write failed
+    if (canAppend && pendingCount < SCORE_LOG_BATCH) {
+        pending[pendingCount++] = record;
+        queued = true;
+    }
+#ifdef __3DS__
+    LightLock_Unlock(&lock);
+    LightEvent_Signal(&wake);
+#else
+    guard.unlock();
+    wake.notify_one();
+#endif
+
+    if (queued) history.push_back(record);
+    return queued;
+}
+
+void ScoreLog::flush() {
+    if (!writerRunning) return;
+#ifdef __3DS__
+    while (true) {
+        LightLock_Lock(&lock);
+        bool done = pendingCount == 0 && inFlight == 0;
+        LightLock_Unlock(&lock);
+        if (done) break;
+        LightEvent_Wait(&drained);
+    }
+#else
+    std::unique_lock<std::mutex> guard(lock);
+    drained.wait(guard, [this] { return pendingCount == 0 && inFlight == 0; });
+#endif
+}
+
+int ScoreLog::highScore(int difficulty) {
+    waitLoaded();
+    int best = 0;
+    for (size_t i = 0; i < history.size(); i++) {
+        if (history[i].difficulty == difficulty && history[i].score > best) best = history[i].score;
+    }
+    return best;
+}
+
+const std::vector<SessionRecord>& ScoreLog::sessions() {
+    waitLoaded();
+    return history;
+}
+
+// Parse every intact record. A damaged one (a flipped byte, or a write
+// torn by a crash) is skipped by scanning ahead for the next magic whose
+// record passes its CRC, so it costs only itself; damaged reports it.
+bool ScoreLog::readFile(const char* file, std::vector<SessionRecord>& out, bool& damaged) {
+    FILE* f = fopen(file, "rb");
+    if (!f) return true; // No log yet
+
+    std::vector<unsigned char> bytes;
+    unsigned char buffer[1024];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), f)) > 0) bytes.insert(bytes.end(), buffer, buffer + got);
+    bool ok = !ferror(f);
+    fclose(f);
+
+    const size_t recordSize = sizeof(RecordHeader) + sizeof(SessionRecord);
+    size_t at = 0;
+    while (at < bytes.size()) {
+        RecordHeader header;
+        SessionRecord record;
+        if (bytes.size() - at >= recordSize) {
+            memcpy(&header, &bytes[at], sizeof(header));
+            memcpy(&record, &bytes[at + sizeof(header)], sizeof(record));
+            if (header.magic == SCORE_LOG_MAGIC && header.length == sizeof(record) &&
+                crc32(&record, sizeof(record)) == header.crc) {
+                out.push_back(record);
+                at += recordSize;
+                continue;
+            }
+        }
+        damaged = true;
+        at++;
+    }
+    return ok;
+}
+
+// Replace the log with the given records. The new log is written to a
+// temp file first so a crash at any point leaves one complete copy.
+bool ScoreLog::rewrite(const std::vector<SessionRecord>& records) {
+    FILE* f = fopen(tmpPath, "wb");
+    if (!f) return false;
+
+    bool ok = true;
+    for (size_t i = 0; i < records.size() && ok; i++) {
+        RecordHeader header = { SCORE_LOG_MAGIC, sizeof(SessionRecord), crc32(&records[i], sizeof(SessionRecord)) };
+        ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(&records[i], sizeof(SessionRecord), 1, f) == 1;
+    }
+    ok = ok && fflush(f) == 0 && fsync(fileno(f)) == 0; // libctru's sdmc fsync flushes the card
+    fclose(f);
+    if (!ok) {
+        remove(tmpPath);
+        return false;
+    }
+
+    // FAT on the SD card can't rename over an existing file
+    remove(path);
+    return rename(tmpPath, path) == 0;
+}
+
+// Keep the most recent sessions and the best few per difficulty, in log order.
+// Returns false if the log couldn't be rewritten.
+bool ScoreLog::compact() {
+    size_t count = history.size();
+    std::vector<bool> keep(count, false);
+
+    for (size_t i = count > SCORE_LOG_KEEP_RECENT ? count - SCORE_LOG_KEEP_RECENT : 0; i < count; i++) keep[i] = true;
+
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return history[a].score > history[b].score;
+    });
+    int kept[3] = { 0, 0, 0 };
+    for (size_t i = 0; i < count; i++) {
+        int difficulty = history[order[i]].difficulty;
+        if (difficulty < 3 && kept[difficulty] < SCORE_LOG_KEEP_BEST) {
+            keep[order[i]] = true;
+            kept[difficulty]++;
+        }
+    }
+
+    std::vector<SessionRecord> compacted;
+    for (size_t i = 0; i < count; i++) {
+        if (keep[i]) compacted.push_back(history[i]);
+    }
+    if (!rewrite(compacted)) return false;
+    history.swap(compacted);
+    return true;
+}
+
+void ScoreLog::startWriter() {
+    if (writerRunning) return;
+#ifdef __3DS__
+    // Run below the game thread so a save never preempts a frame
+    s32 priority = 0x30;
+    svcGetThreadPriority(&priority, CUR_THREAD_HANDLE);
+    writer = threadCreate(writerEntry, this, WRITER_STACK_SIZE, std::min(priority + 1, 0x3F), -2, false);
+    writerRunning = writer != nullptr;
+#else
+    writer = std::thread(&ScoreLog::writerLoop, this);
+    writerRunning = true;
+#endif
+}
+
+#ifdef __3DS__
+void ScoreLog::writerEntry(void* arg) {
+    static_cast<ScoreLog*>(arg)->writerLoop();
+}
+#endif
+
+// Background thread: loads the log, then takes the whole pending batch
+// and appends it in one write. After a failed write nothing more is
+// appended this run, and sessions still queued are dropped.
+void ScoreLog::writerLoop() {
+    SessionRecord batch[SCORE_LOG_BATCH];
+
+    bool appendable;
+    bool ok = readLog(appendable);
+    finishLoad(ok, appendable);
+    if (!appendable) return; // submit() refuses sessions, so there is nothing to write
+
+    while (true) {
+        int count;
+#ifdef __3DS__
+        LightLock_Lock(&lock);
+        while (pendingCount == 0 && !stopRequested) {
+            LightLock_Unlock(&lock);
+            LightEvent_Wait(&wake);
+            LightLock_Lock(&lock);
+        }
+#else
+        std::unique_lock<std::mutex> guard(lock);
+        wake.wait(guard, [this] { return pendingCount > 0 || stopRequested; });
+#endif
+        count = pendingCount;
+        memcpy(batch, pending, count * sizeof(SessionRecord));
+        inFlight = count;
+        pendingCount = 0;
+        bool writable = canAppend;
+#ifdef __3DS__
+        LightLock_Unlock(&lock);
+#else
+        guard.unlock();
+#endif
+
+        if (count == 0) break; // Stop requested and nothing left to write
+        bool written = writable && appendBatch(batch, count);
+
+#ifdef __3DS__
+        LightLock_Lock(&lock);
+        inFlight = 0;
+        if (!written) canAppend = false;
+        LightLock_Unlock(&lock);
+        LightEvent_Signal(&drained);
+#else
+        guard.lock();
+        inFlight = 0;
+        if (!written) canAppend = false;
+        guard.unlock();
+        drained.notify_all();
+#endif
+    }
+}
+
+bool ScoreLog::appendBatch(const SessionRecord* batch, int count) {
+    // Build the whole batch first so it reaches the file in a single write
+    unsigned char buffer[SCORE_LOG_BATCH * (sizeof(RecordHeader) + sizeof(SessionRecord))];
+    size_t size = 0;
+    for (int i = 0; i < count; i++) {
+        RecordHeader header = { SCORE_LOG_MAGIC, sizeof(SessionRecord), crc32(&batch[i], sizeof(SessionRecord)) };
+        memcpy(buffer + size, &header, sizeof(header));
+        size += sizeof(header);
+        memcpy(buffer + size, &batch[i], sizeof(SessionRecord));
+        size += sizeof(SessionRecord);
+    }
+
+    FILE* f = fopen(path, "ab");
+    if (!f) return false;
+    setvbuf(f, nullptr, _IONBF, 0); // So nothing buffered can land after a truncate
+    fseek(f, 0, SEEK_END);
+    long before = ftell(f);
+    bool ok = before >= 0 && fwrite(buffer, 1, size, f) == size && fflush(f) == 0 && fsync(fileno(f)) == 0;
+
+    // A partial write (card full or pulled) leaves a torn record at the end;
+    // cut it off so the file still ends on a whole record
+    if (!ok && before >= 0) ftruncate(fileno(f), before);
+    fclose(f);
+    return ok;
+}
+
+// Standard CRC-32 (IEEE); records are tiny so a bitwise loop is enough
+uint32_t ScoreLog::crc32(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
@@ -0,0 +1,477 @@
+// Host-side texture atlas builder.
+//
+// Packs every PNG in a gfx/ folder into power-of-two atlas pages with a
+// skyline packer, then writes for each page the texture data already in
+// the 3DS GPU's native layout (8x8 Morton-ordered tiles, rows flipped,
+// RGBA8 stored as ABGR), plus one header with the UV rect of every sprite.
+// Drawing all sprites from one page then needs a single texture bind.
+//
+// Build from 3ds_project_common:
+//   g++ -std=gnu++11 -O2 tools/atlas_builder.cpp -lpng -o atlas_builder
+//
+// Run:
+//   ./atlas_builder <gfx dir> <out dir> [--name atlas] [--max-size 1024] [--padding 1]
+//   ./atlas_builder --synthetic <count> <out dir>   pack random sprites to measure the packer
+//
+// Output, for --name atlas:
+//   <out dir>/atlas_page0.bin ...  raw tiled texture data, load with C3D_TexInit + memcpy
+//   <out dir>/atlas.h              page sizes, sprite ids and UV rects
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <png.h>
+
+#define MIN_PAGE_SIZE 8       // GPU textures are at least 8x8
+#define MAX_PAGE_SIZE 1024    // Largest texture the 3DS GPU accepts
+
+struct Sprite {
+    std::string name;
+    int width, height;
+    std::vector<unsigned char> rgba; // Row-major, top row first
+    int page, x, y;                  // Placement, filled in by the packer
+};
+
+struct Page {
+    int width, height;
+    long long usedArea; // Pixels covered by sprites (without padding)
+};
+
+// One segment of the skyline: the top edge of everything packed below it
+struct SkylineNode {
+    int x, y, width;
+};
+
+// Bottom-left skyline packer for one page
+class SkylinePacker {
+public:
+    SkylinePacker(int width, int height) : width(width), height(height) {
+        SkylineNode first = { 0, 0, width };
+        skyline.push_back(first);
+    }
+
+    // Find the lowest position for a w x h box; false if it doesn't fit
+    bool insert(int w, int h, int& outX, int& outY) {
+        int bestIndex = -1, bestY = height, bestWidth = width;
+
+        // Lowest resting place wins; ties go to the narrowest skyline segment
+        for (size_t i = 0; i < skyline.size(); i++) {
+            int y;
+            if (fits(i, w, h, y) && (bestIndex < 0 || y < bestY || (y == bestY && skyline[i].width < bestWidth))) {
+                bestIndex = (int)i;
+                bestY = y;
+                bestWidth = skyline[i].width;
+            }
+        }
+        if (bestIndex < 0) return false;
+
+        outX = skyline[bestIndex].x;
+        outY = bestY;
+        addLevel(bestIndex, outX, outY, w, h);
+        return true;
+    }
+
+private:
+    int width, height;
+    std::vector<SkylineNode> skyline;
+
+    // Can a w x h box rest on the skyline starting at node i?
+    bool fits(size_t i, int w, int h, int& y) const {
+        int x = skyline[i].x;
+        if (x + w > width) return false;
+
+        int left = w;
+        y = skyline[i].y;
+        while (left > 0) {
+            y = std::max(y, skyline[i].y);
+            if (y + h > height) return false;
+            left -= skyline[i].width;
+            i++;
+            if (left > 0 && i >= skyline.size()) return false;
+        }
+        return true;
+    }
+
+    // Raise the skyline under the newly placed box and merge equal levels
+    void addLevel(int index, int x, int y, int w, int h) {
+        SkylineNode node = { x, y + h, w };
+        skyline.insert(skyline.begin() + index, node);
+
+        for (size_t i = index + 1; i < skyline.size(); i++) {
+            int overlap = skyline[i - 1].x + skyline[i - 1].width - skyline[i].x;
+            if (overlap <= 0) break;
+            skyline[i].x += overlap;
+            skyline[i].width -= overlap;
+            if (skyline[i].width > 0) break;
+            skyline.erase(skyline.begin() + i);
+            i--;
+        }
+        for (size_t i = 0; i + 1 < skyline.size(); i++) {
+            if (skyline[i].y == skyline[i + 1].y) {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+                i--;
+            }
+        }
+    }
+};
+
+static int nextPowerOfTwo(int value) {
+    int size = MIN_PAGE_SIZE;
+    while (size < value) size *= 2;
+    return size;
+}
+
+static bool loadPng(const std::string& file, Sprite& sprite) {
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&image, file.c_str())) return false;
+
+    image.format = PNG_FORMAT_RGBA;
+    sprite.width = image.width;
+    sprite.height = image.height;
+    sprite.rgba.resize(PNG_IMAGE_SIZE(image));
+    if (!png_image_finish_read(&image, nullptr, sprite.rgba.data(), 0, nullptr)) {
+        png_image_free(&image);
+        return false;
+    }
+    return true;
+}
+
+static bool loadFolder(const char* dir, std::vector<Sprite>& sprites) {
+    DIR* folder = opendir(dir);
+    if (!folder) return false;
+
+    std::vector<std::string> files;
+    while (dirent* entry = readdir(folder)) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".png") == 0) files.push_back(name);
+    }
+    closedir(folder);
+    std::sort(files.begin(), files.end()); // Stable sprite ids between runs
+
+    for (size_t i = 0; i < files.size(); i++) {
+        Sprite sprite;
+        sprite.name = files[i].substr(0, files[i].size() - 4);
+        if (!loadPng(std::string(dir) + "/" + files[i], sprite)) {
+            fprintf(stderr, "Can't read %s/%s\n", dir, files[i].c_str());
+            return false;
+        }
+        sprites.push_back(sprite);
+    }
+    return true;
+}
+
+// Random sprite sizes in the range of typical game sprites
+static void makeSyntheticSprites(int count, std::vector<Sprite>& sprites) {
+    srand(1234);
+    for (int i = 0; i < count; i++) {
+        Sprite sprite;
+        char name[32];
+        snprintf(name, sizeof(name), "sprite%d", i);
+        sprite.name = name;
+        sprite.width = 8 + rand() % 57;
+        sprite.height = 8 + rand() % 57;
+        sprite.rgba.assign(sprite.width * sprite.height * 4, (unsigned char)i);
+        sprites.push_back(sprite);
+    }
+}
+
+// Try to place every listed sprite on one page; sprites that don't fit
+// are returned in leftOver
+static void packPage(std::vector<Sprite>& sprites, const std::vector<size_t>& order, int pageIndex,
+                     int width, int height, int padding, std::vector<size_t>& leftOver) {
+    SkylinePacker packer(width, height);
+    leftOver.clear();
+    for (size_t n = 0; n < order.size(); n++) {
+        Sprite& sprite = sprites[order[n]];
+        int x, y;
+        if (packer.insert(sprite.width + padding * 2, sprite.height + padding * 2, x, y)) {
+            sprite.page = pageIndex;
+            sprite.x = x + padding;
+            sprite.y = y + padding;
+        } else {
+            leftOver.push_back(order[n]);
+        }
+    }
+}
+
+// Pack tallest sprites first. Each page is the smallest power-of-two size
+// that holds every sprite left; if none does, a full-size page is filled
+// and the rest moves on to the next page.
+static bool pack(std::vector<Sprite>& sprites, int maxSize, int padding, std::vector<Page>& pages) {
+    std::vector<size_t> remaining(sprites.size());
+    for (size_t i = 0; i < remaining.size(); i++) remaining[i] = i;
+    std::stable_sort(remaining.begin(), remaining.end(), [&sprites](size_t a, size_t b) {
+        if (sprites[a].height != sprites[b].height) return sprites[a].height > sprites[b].height;
+        return sprites[a].width > sprites[b].width;
+    });
+
+    for (size_t n = 0; n < remaining.size(); n++) {
+        const Sprite& sprite = sprites[remaining[n]];
+        if (sprite.width + padding * 2 > maxSize || sprite.height + padding * 2 > maxSize) {
+            fprintf(stderr, "%s (%dx%d) is larger than a %d page\n", sprite.name.c_str(), sprite.width, sprite.height, maxSize);
+            return false;
+        }
+    }
+
+    // Candidate page sizes, smallest area first, squarer pages first on ties
+    std::vector<Page> sizes;
+    for (int w = MIN_PAGE_SIZE; w <= maxSize; w *= 2) {
+        for (int h = MIN_PAGE_SIZE; h <= maxSize; h *= 2) {
+            Page page = { w, h, 0 };
+            sizes.push_back(page);
+        }
+    }
+    std::stable_sort(sizes.begin(), sizes.end(), [](const Page& a, const Page& b) {
+        long long areaA = (long long)a.width * a.height, areaB = (long long)b.width * b.height;
+        if (areaA != areaB) return areaA < areaB;
+        return std::abs(a.width - a.height) < std::abs(b.width - b.height);
+    });
+
+    std::vector<size_t> leftOver;
+    while (!remaining.empty()) {
+        int pageIndex = (int)pages.size();
+        long long needed = 0;
+        for (size_t n = 0; n < remaining.size(); n++) {
+            needed += (long long)(sprites[remaining[n]].width + padding * 2) * (sprites[remaining[n]].height + padding * 2);
+        }
+
+        Page page = { maxSize, maxSize, 0 };
+        bool fitted = false;
+        for (size_t i = 0; i < sizes.size() && !fitted; i++) {
+            if ((long long)sizes[i].width * sizes[i].height < needed) continue;
+            packPage(sprites, remaining, pageIndex, sizes[i].width, sizes[i].height, padding, leftOver);
+            if (leftOver.empty()) {
+                page = sizes[i];
+                fitted = true;
+            }
+        }
+        if (!fitted) packPage(sprites, remaining, pageIndex, maxSize, maxSize, padding, leftOver);
+
+        pages.push_back(page);
+        remaining.swap(leftOver);
+    }
+
+    for (size_t i = 0; i < sprites.size(); i++) pages[sprites[i].page].usedArea += (long long)sprites[i].width * sprites[i].height;
+    return true;
+}
+
+// Position of pixel (x, y) inside its 8x8 tile: x and y bits interleaved
+static int morton(int x, int y) {
+    int index = 0;
+    for (int bit = 0; bit < 3; bit++) {
+        index |= ((x >> bit) & 1) << (bit * 2);
+        index |= ((y >> bit) & 1) << (bit * 2 + 1);
+    }
+    return index;
+}
+
+// Copy the page's sprites into GPU tiled order. Edge pixels are extended
+// into the padding so filtering never samples a neighbouring sprite.
+static std::vector<unsigned char> buildPage(const std::vector<Sprite>& sprites, int pageIndex, const Page& page, int padding) {
+    std::vector<unsigned char> linear(page.width * page.height * 4, 0);
+    for (size_t i = 0; i < sprites.size(); i++) {
+        const Sprite& sprite = sprites[i];
+        if (sprite.page != pageIndex) continue;
+
+        for (int y = -padding; y < sprite.height + padding; y++) {
+            int sy = std::min(std::max(y, 0), sprite.height - 1);
+            for (int x = -padding; x < sprite.width + padding; x++) {
+                int sx = std::min(std::max(x, 0), sprite.width - 1);
+                memcpy(&linear[((sprite.y + y) * page.width + sprite.x + x) * 4], &sprite.rgba[(sy * sprite.width + sx) * 4], 4);
+            }
+        }
+    }
+
+    std::vector<unsigned char> tiled(linear.size());
+    for (int y = 0; y < page.height; y++) {
+        int flippedY = page.height - 1 - y; // GPU textures start at the bottom row
+        for (int x = 0; x < page.width; x++) {
+            int tile = (flippedY / 8) * (page.width / 8) + x / 8;
+            unsigned char* out = &tiled[(tile * 64 + morton(x % 8, flippedY % 8)) * 4];
+            const unsigned char* in = &linear[(y * page.width + x) * 4];
+            out[0] = in[3]; // GPU_RGBA8 is stored as A, B, G, R
+            out[1] = in[2];
+            out[2] = in[1];
+            out[3] = in[0];
+        }
+    }
+    return tiled;
+}
+
+// Upper-case C identifier for a name
+static std::string identifier(const std::string& name) {
+    std::string id = name;
+    for (size_t i = 0; i < id.size(); i++) {
+        char c = id[i];
+        if (c >= 'a' && c <= 'z') id[i] = c - 'a' + 'A';
+        else if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))) id[i] = '_';
+    }
+    return id;
+}
+
+// Everything the header defines must be a valid C identifier and unique:
+// "a-b.png" and "a_b.png" would both become ATLAS_A_B
+static bool checkIdentifiers(const std::string& name, const std::vector<Sprite>& sprites) {
+    std::string upper = identifier(name);
+    if (upper.empty() || (upper[0] >= '0' && upper[0] <= '9')) {
+        fprintf(stderr, "--name %s doesn't make a C identifier\n", name.c_str());
+        return false;
+    }
+
+    std::map<std::string, std::string> used; // Identifier, what it names
+    static const char* const OWN[] = { "_ATLAS_H", "_PAGE_COUNT", "_PAGE_SIZE", "_SPRITE_COUNT", "_RECTS" };
+    for (size_t i = 0; i < sizeof(OWN) / sizeof(OWN[0]); i++) used[upper + OWN[i]] = "the header itself";
+    for (size_t i = 0; i < sprites.size(); i++) {
+        std::string id = identifier(name + "_" + sprites[i].name);
+        std::map<std::string, std::string>::const_iterator clash = used.find(id);
+        if (clash != used.end()) {
+            fprintf(stderr, "%s.png and %s both become %s\n", sprites[i].name.c_str(), clash->second.c_str(), id.c_str());
+            return false;
+        }
+        used[id] = sprites[i].name + ".png";
+    }
+    return true;
+}
+
+static bool writeHeader(const std::string& file, const std::string& name, const std::vector<Sprite>& sprites, const std::vector<Page>& pages) {
+    FILE* f = fopen(file.c_str(), "w");
+    if (!f) return false;
+
+    std::string upper = identifier(name);
+    fprintf(f, "// Generated by atlas_builder, do not edit\n");
+    fprintf(f, "#ifndef %s_ATLAS_H\n#define %s_ATLAS_H\n\n", upper.c_str(), upper.c_str());
+    fprintf(f, "#define %s_PAGE_COUNT %d\n\n", upper.c_str(), (int)pages.size());
+    fprintf(f, "// Texture size of each %s_pageN.bin (GPU_RGBA8, already tiled)\n", name.c_str());
+    fprintf(f, "static const unsigned short %s_PAGE_SIZE[%d][2] = {\n", upper.c_str(), (int)pages.size());
+    for (size_t p = 0; p < pages.size(); p++) fprintf(f, "    { %d, %d },\n", pages[p].width, pages[p].height);
+    fprintf(f, "};\n\n");
+
+    fprintf(f, "enum {\n");
+    for (size_t i = 0; i < sprites.size(); i++) fprintf(f, "    %s = %d,\n", identifier(name + "_" + sprites[i].name).c_str(), (int)i);
+    fprintf(f, "    %s_SPRITE_COUNT = %d\n};\n\n", upper.c_str(), (int)sprites.size());
+
+    // Same convention as Tex3DS_SubTexture: top > bottom because textures are flipped
+    fprintf(f, "typedef struct {\n    unsigned char page;\n    unsigned short width, height;\n");
+    fprintf(f, "    float left, top, right, bottom;\n} %s_Rect;\n\n", upper.c_str());
+    fprintf(f, "static const %s_Rect %s_RECTS[%s_SPRITE_COUNT] = {\n", upper.c_str(), upper.c_str(), upper.c_str());
+    for (size_t i = 0; i < sprites.size(); i++) {
+        const Sprite& s = sprites[i];
+        const Page& page = pages[s.page];
+        fprintf(f, "    { %d, %d, %d, %.8ff, %.8ff, %.8ff, %.8ff }, // %s\n", s.page, s.width, s.height,
+                (float)s.x / page.width, 1.0f - (float)s.y / page.height,
+                (float)(s.x + s.width) / page.width, 1.0f - (float)(s.y + s.height) / page.height, s.name.c_str());
+    }
+    fprintf(f, "};\n\n#endif\n");
+    fclose(f);
+    return true;
+}
+
+// Whole decimal number, nothing after it
+static bool parseInt(const char* text, int& out) {
+    char* end;
+    long value = strtol(text, &end, 10);
+    if (!*text || *end || value < -1000000 || value > 1000000) return false;
+    out = (int)value;
+    return true;
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <gfx dir> <out dir> [--name atlas] [--max-size 1024] [--padding 1]\n", argv[0]);
+        fprintf(stderr, "       %s --synthetic <count> <out dir>\n", argv[0]);
+        return 1;
+    }
+
+    std::string name = "atlas";
+    int maxSize = MAX_PAGE_SIZE, padding = 1, synthetic = 0;
+    const char* gfxDir = argv[1];
+    const char* outDir = argv[2];
+    int arg = 3;
+    if (strcmp(argv[1], "--synthetic") == 0) {
+        if (argc < 4 || !parseInt(argv[2], synthetic) || synthetic < 1) {
+            fprintf(stderr, "--synthetic needs a sprite count and an out dir\n");
+            return 1;
+        }
+        outDir = argv[3];
+        arg = 4;
+    }
+    for (; arg < argc; arg += 2) {
+        const char* option = argv[arg];
+        const char* value = arg + 1 < argc ? argv[arg + 1] : nullptr;
+        int number = 0;
+        if (!value) {
+            fprintf(stderr, "%s needs a value\n", option);
+            return 1;
+        }
+        if (strcmp(option, "--name") == 0) {
+            name = value;
+        } else if (strcmp(option, "--max-size") == 0 && parseInt(value, number) && number > 0) {
+            maxSize = nextPowerOfTwo(std::min(number, MAX_PAGE_SIZE));
+        } else if (strcmp(option, "--padding") == 0 && parseInt(value, number) && number >= 0) {
+            padding = number;
+        } else {
+            fprintf(stderr, "Bad option %s %s\n", option, value);
+            return 1;
+        }
+    }
+
+    std::vector<Sprite> sprites;
+    std::vector<Page> pages;
+    auto start = std::chrono::steady_clock::now();
+
+    if (synthetic > 0) makeSyntheticSprites(synthetic, sprites);
+    else if (!loadFolder(gfxDir, sprites)) return 1;
+    if (sprites.empty()) {
+        fprintf(stderr, "No .png sprites in %s\n", gfxDir); // The header's arrays would be empty
+        return 1;
+    }
+    if (!checkIdentifiers(name, sprites)) return 1;
+    double loadMs = msSince(start);
+
+    start = std::chrono::steady_clock::now();
+    if (!pack(sprites, maxSize, padding, pages)) return 1;
+    double packMs = msSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t p = 0; p < pages.size(); p++) {
+        std::vector<unsigned char> data = buildPage(sprites, (int)p, pages[p], padding);
+        std::string file = std::string(outDir) + "/" + name + "_page" + std::to_string(p) + ".bin";
+        FILE* f = fopen(file.c_str(), "wb");
+        if (!f || fwrite(data.data(), 1, data.size(), f) != data.size()) {
+            fprintf(stderr, "Can't write %s\n", file.c_str());
+            return 1;
+        }
+        fclose(f);
+    }
+    if (!writeHeader(std::string(outDir) + "/" + name + ".h", name, sprites, pages)) {
+        fprintf(stderr, "Can't write %s/%s.h\n", outDir, name.c_str());
+        return 1;
+    }
+    double writeMs = msSince(start);
+
+    // Packing report
+    long long spriteArea = 0, pageArea = 0;
+    printf("%d sprites in %d page(s)\n", (int)sprites.size(), (int)pages.size());
+    for (size_t p = 0; p < pages.size(); p++) {
+        long long area = (long long)pages[p].width * pages[p].height;
+        spriteArea += pages[p].usedArea;
+        pageArea += area;
+        printf("  page %d: %dx%d, %.1f%% filled\n", (int)p, pages[p].width, pages[p].height, 100.0 * pages[p].usedArea / area);
+    }
+    printf("efficiency: %.1f%% of %lld texels\n", pageArea ? 100.0 * spriteArea / pageArea : 0.0, pageArea);
+    printf("time: load %.2f ms, pack %.2f ms, write %.2f ms\n", loadMs, packMs, writeMs);
+    return 0;
+}
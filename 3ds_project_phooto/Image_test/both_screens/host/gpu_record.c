@@ -0,0 +1,94 @@
+#include <stdlib.h>
+#include <string.h>
+#include "gpu.h"
+#include "gpu_record.h"
+
+// Linux stand-in for gpu_citro3d.c: nothing is drawn, every call is counted
+
+static gpu_record record;
+static size_t frameStartBytes;
+
+void gpuRecordReset(void)
+{
+	memset(&record, 0, sizeof(record));
+	frameStartBytes = 0;
+}
+
+const gpu_record* gpuRecordGet(void)
+{
+	return &record;
+}
+
+void gpuInit(bool stereo)
+{
+	(void)stereo;
+	gpuRecordReset();
+}
+
+void gpuExit(void)
+{
+}
+
+void* gpuAllocVertices(size_t size)
+{
+	return malloc(size);
+}
+
+void gpuFreeVertices(void* data)
+{
+	free(data);
+}
+
+void gpuBindVertices(void* data, size_t stride)
+{
+	(void)data;
+	(void)stride;
+}
+
+void gpuVerticesWritten(const void* data, size_t size)
+{
+	(void)data;
+	record.vertexBytesWritten += size;
+	record.vertexWrites++;
+}
+
+void gpuFrameBegin(void)
+{
+	frameStartBytes = record.vertexBytesWritten;
+}
+
+void gpuFrameEnd(void)
+{
+	size_t bytes = record.vertexBytesWritten - frameStartBytes;
+	if (bytes > record.worstFrameBytes)
+		record.worstFrameBytes = bytes;
+	record.frames++;
+}
+
+void gpuBeginTarget(gpu_target target)
+{
+	(void)target;
+	record.targetsDrawn++;
+}
+
+void gpuSetColor(float r, float g, float b, float a)
+{
+	(void)r;
+	(void)g;
+	(void)b;
+	(void)a;
+}
+
+void gpuSetProjection(gpu_target target, float eyeShift)
+{
+	(void)target;
+	(void)eyeShift;
+	record.projectionsSet++;
+}
+
+void gpuDrawTriangles(int first, int count)
+{
+	(void)first;
+	record.drawCalls++;
+	record.verticesDrawn += count;
+}
@@ -0,0 +1,22 @@
+#ifndef GPU_RECORD_H
+#define GPU_RECORD_H
+
+#include <stddef.h>
+
+// What the recording backend saw since the last gpuRecordReset()
+typedef struct
+{
+	size_t vertexBytesWritten; // CPU-side vertex generation
+	int vertexWrites;
+	int frames;
+	size_t worstFrameBytes;    // Most vertex bytes written between one gpuFrameBegin() and gpuFrameEnd()
+	int targetsDrawn;
+	int projectionsSet;
+	int drawCalls;
+	int verticesDrawn;
+} gpu_record;
+
+void gpuRecordReset(void);
+const gpu_record* gpuRecordGet(void);
+
+#endif
@@ -0,0 +1,172 @@
+// Runs the scene on Linux against the recording backend and compares the
+// CPU-side work of mono and stereo frames, then checks that the maze's
+// per-frame vertex uploads stay the same as the maze grows. Exits with 1
+// if the second eye generated any vertex data of its own, if a frame wrote
+// anything besides the moving actor and eaten pellets, or if steady-state
+// uploads depend on the maze size.
+//
+// Build from both_screens:
+//   gcc -std=gnu99 -O2 -Isource -Ihost -I../../../3ds_project_common/include source/scene.c source/maze_mesh.c host/gpu_record.c host/main.c -lm -o scene_host
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "gpu.h"
+#include "gpu_record.h"
+#include "maze_layout.h"
+#include "maze_mesh.h"
+#include "scene.h"
+
+#define FRAMES 600
+#define GHOSTS 4
+
+static gpu_record runFrames(bool stereo)
+{
+	gpuInit(stereo);
+	if (!sceneInit())
+	{
+		printf("FAIL: sceneInit couldn't allocate its buffers\n");
+		exit(1);
+	}
+	gpuRecordReset(); // Count frames only, not the level load
+
+	float count = 0.0f;
+	for (int i = 0; i < FRAMES; i++)
+	{
+		sceneRender(count, stereo, 4.0f);
+		count += 1/128.0f;
+	}
+
+	gpu_record result = *gpuRecordGet();
+	sceneExit();
+	gpuExit();
+	return result;
+}
+
+static void report(const char* mode, const gpu_record* r)
+{
+	printf("%-6s per frame: %zu vertex bytes written (%d writes), %d targets, %d projections, %d draws, %d vertices drawn\n",
+		mode, r->vertexBytesWritten / FRAMES, r->vertexWrites / FRAMES, r->targetsDrawn / FRAMES,
+		r->projectionsSet / FRAMES, r->drawCalls / FRAMES, r->verticesDrawn / FRAMES);
+}
+
+// A width x height maze: walls round the edge and a grid of pillars, pellets everywhere else
+static char** makeMaze(int width, int height)
+{
+	char** rows = (char**)malloc(height * sizeof(char*));
+	for (int y = 0; y < height; y++)
+	{
+		rows[y] = (char*)malloc(width + 1);
+		for (int x = 0; x < width; x++)
+		{
+			bool edge = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+			rows[y][x] = edge || (x % 4 == 2 && y % 3 == 2) ? '#' : '.';
+		}
+		rows[y][width] = '\0';
+	}
+	return rows;
+}
+
+// Load a maze at scale times the game's size and play FRAMES frames: Pac-Man
+// eats along the top corridor while the ghosts drift. Returns the steady
+// state record; loadBytes gets what the level load wrote.
+static gpu_record runMaze(int scale, size_t* loadBytes, int* pellets)
+{
+	int width = MAZE_WIDTH * scale, height = MAZE_HEIGHT * scale;
+	float tileWidth = SCENE_TILE_WIDTH / scale, tileHeight = SCENE_TILE_HEIGHT / scale;
+	char** rows = makeMaze(width, height);
+	maze_mesh mesh;
+
+	gpuInit(false);
+	if (!mazeMeshLoad(&mesh, (const char* const*)rows, width, height, tileWidth, tileHeight,
+		SCENE_MAZE_LEFT(width * tileWidth), SCENE_MAZE_TOP(height * tileHeight)))
+	{
+		printf("FAIL: mazeMeshLoad couldn't allocate a %dx%d maze\n", width, height);
+		exit(1);
+	}
+	*loadBytes = gpuRecordGet()->vertexBytesWritten;
+	*pellets = mesh.pelletCount;
+	gpuRecordReset();
+
+	for (int i = 0; i < FRAMES; i++)
+	{
+		gpuFrameBegin();
+		float x = 1.0f + (float)(i % (8 * (width - 3))) / 8;
+		mazeMeshSetActor(&mesh, 0, x, 1.0f);
+		mazeMeshHidePellet(&mesh, (int)(x + 0.5f), 1);
+		for (int g = 1; g <= GHOSTS; g++)
+			mazeMeshSetActor(&mesh, g, (float)(i % width), (float)(g * height / (GHOSTS + 1)));
+		mazeMeshUpdate(&mesh);
+		gpuBeginTarget(TARGET_TOP_LEFT);
+		gpuSetProjection(TARGET_TOP_LEFT, 0.0f);
+		mazeMeshDraw(&mesh);
+		gpuFrameEnd();
+	}
+
+	gpu_record result = *gpuRecordGet();
+	mazeMeshFree(&mesh);
+	gpuExit();
+	for (int y = 0; y < height; y++)
+		free(rows[y]);
+	free(rows);
+	return result;
+}
+
+static int checkMazeUploads(void)
+{
+	static const int SCALES[] = { 1, 2, 4 };
+	size_t firstWorst = 0;
+	bool ok = true;
+
+	for (size_t i = 0; i < sizeof(SCALES) / sizeof(SCALES[0]); i++)
+	{
+		size_t loadBytes;
+		int pellets;
+		gpu_record r = runMaze(SCALES[i], &loadBytes, &pellets);
+		printf("maze %3dx%-3d %5d pellets: load %7zu bytes (a per-frame rebuild would write this every frame), "
+			"steady %3zu bytes/frame average, %3zu worst, %d draws/frame\n",
+			MAZE_WIDTH * SCALES[i], MAZE_HEIGHT * SCALES[i], pellets, loadBytes, r.vertexBytesWritten / r.frames,
+			r.worstFrameBytes, r.drawCalls / r.frames);
+		if (i == 0)
+			firstWorst = r.worstFrameBytes;
+		else if (r.worstFrameBytes != firstWorst)
+			ok = false;
+	}
+
+	if (!ok)
+	{
+		printf("FAIL: per-frame uploads grow with the maze\n");
+		return 1;
+	}
+	printf("OK: per-frame uploads are the same at every maze size\n");
+	return 0;
+}
+
+int main(void)
+{
+	gpu_record mono = runFrames(false);
+	gpu_record stereo = runFrames(true);
+
+	report("mono", &mono);
+	report("stereo", &stereo);
+
+	int eyeWrites = stereo.vertexWrites - mono.vertexWrites;
+	long eyeBytes = (long)stereo.vertexBytesWritten - (long)mono.vertexBytesWritten;
+	printf("second eye: %d vertex writes, %ld bytes over %d frames\n", eyeWrites, eyeBytes, FRAMES);
+	if (eyeWrites != 0 || eyeBytes != 0)
+	{
+		printf("FAIL: the second eye generated vertex data\n");
+		return 1;
+	}
+	printf("OK: stereo adds %d draw(s) per frame and no vertex generation\n", (stereo.drawCalls - mono.drawCalls) / FRAMES);
+
+	// Only Pac-Man moves, so a frame writes its quad and at most one eaten pellet's
+	size_t frameLimit = 2 * MAZE_MESH_QUAD_VERTICES * sizeof(vertex);
+	if (mono.worstFrameBytes > frameLimit)
+	{
+		printf("FAIL: a frame wrote %zu vertex bytes, more than the moving actor and eaten pellet (%zu)\n",
+			mono.worstFrameBytes, frameLimit);
+		return 1;
+	}
+	printf("OK: frames write at most %zu vertex bytes, all of them actor or pellet patches\n", mono.worstFrameBytes);
+	return checkMazeUploads();
+}
@@ -0,0 +1,33 @@
+#ifndef GPU_H
+#define GPU_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Drawing calls used by the scene. gpu_citro3d.c implements them on the
+// 3DS; host/gpu_record.c records them on Linux so the scene's CPU work
+// can be counted without a GPU.
+
+typedef enum
+{
+	TARGET_TOP_LEFT,
+	TARGET_TOP_RIGHT, // Only drawn in stereo mode
+	TARGET_BOTTOM,
+} gpu_target;
+
+void gpuInit(bool stereo);
+void gpuExit(void);
+
+void* gpuAllocVertices(size_t size);
+void gpuFreeVertices(void* data);
+void gpuBindVertices(void* data, size_t stride); // Vertex buffer for the following draws
+void gpuVerticesWritten(const void* data, size_t size); // The CPU finished writing vertex data
+
+void gpuFrameBegin(void);
+void gpuFrameEnd(void);
+void gpuBeginTarget(gpu_target target); // Clear the target and draw on it
+void gpuSetColor(float r, float g, float b, float a);
+void gpuSetProjection(gpu_target target, float eyeShift); // Screen projection moved eyeShift pixels sideways
+void gpuDrawTriangles(int first, int count);
+
+#endif
@@ -0,0 +1,137 @@
+#include <3ds.h>
+#include <citro3d.h>
+#include "gpu.h"
+#include "vshader_shbin.h"
+
+#define CLEAR_COLOR 0x68B0D8FF
+
+#define DISPLAY_TRANSFER_FLAGS \
+	(GX_TRANSFER_FLIP_VERT(0) | GX_TRANSFER_OUT_TILED(0) | GX_TRANSFER_RAW_COPY(0) | \
+	GX_TRANSFER_IN_FORMAT(GX_TRANSFER_FMT_RGBA8) | GX_TRANSFER_OUT_FORMAT(GX_TRANSFER_FMT_RGB8) | \
+	GX_TRANSFER_SCALING(GX_TRANSFER_SCALE_NO))
+
+static DVLB_s* vshader_dvlb;
+static shaderProgram_s program;
+static int uLoc_projection;
+static C3D_Mtx projectionTop, projectionBot;
+static C3D_RenderTarget* targets[3];
+
+void gpuInit(bool stereo)
+{
+	C3D_Init(C3D_DEFAULT_CMDBUF_SIZE);
+
+	// Initialize the render targets; the right eye only exists in stereo mode
+	targets[TARGET_TOP_LEFT] = C3D_RenderTargetCreate(240, 400, GPU_RB_RGBA8, GPU_RB_DEPTH24_STENCIL8);
+	C3D_RenderTargetSetOutput(targets[TARGET_TOP_LEFT], GFX_TOP, GFX_LEFT, DISPLAY_TRANSFER_FLAGS);
+	targets[TARGET_TOP_RIGHT] = NULL;
+	if (stereo)
+	{
+		targets[TARGET_TOP_RIGHT] = C3D_RenderTargetCreate(240, 400, GPU_RB_RGBA8, GPU_RB_DEPTH24_STENCIL8);
+		C3D_RenderTargetSetOutput(targets[TARGET_TOP_RIGHT], GFX_TOP, GFX_RIGHT, DISPLAY_TRANSFER_FLAGS);
+	}
+	targets[TARGET_BOTTOM] = C3D_RenderTargetCreate(240, 320, GPU_RB_RGBA8, GPU_RB_DEPTH24_STENCIL8);
+	C3D_RenderTargetSetOutput(targets[TARGET_BOTTOM], GFX_BOTTOM, GFX_LEFT, DISPLAY_TRANSFER_FLAGS);
+
+	// Load the vertex shader, create a shader program and bind it
+	vshader_dvlb = DVLB_ParseFile((u32*)vshader_shbin, vshader_shbin_size);
+	shaderProgramInit(&program);
+	shaderProgramSetVsh(&program, &vshader_dvlb->DVLE[0]);
+	C3D_BindProgram(&program);
+
+	// Get the location of the uniforms
+	uLoc_projection = shaderInstanceGetUniformLocation(program.vertexShader, "projection");
+
+	// Configure attributes for use with the vertex shader
+	C3D_AttrInfo* attrInfo = C3D_GetAttrInfo();
+	AttrInfo_Init(attrInfo);
+	AttrInfo_AddLoader(attrInfo, 0, GPU_FLOAT, 3); // v0=position
+	AttrInfo_AddFixed(attrInfo, 1); // v1=color
+
+	// Set the fixed attribute (color) to solid white
+	C3D_FixedAttribSet(1, 1.0, 1.0, 1.0, 1.0);
+
+	// Compute the projection matrix
+	Mtx_OrthoTilt(&projectionTop, -200.0f, 200.0f, 0.0f, 240.0f, 0.0f, 1.0f, true);
+	Mtx_OrthoTilt(&projectionBot, -160.0f, 160.0f, 0.0f, 240.0f, 0.0f, 1.0f, true);
+
+	// Configure the first fragment shading substage to just pass through the vertex color
+	// See https://www.opengl.org/sdk/docs/man2/xhtml/glTexEnv.xml for more insight
+	C3D_TexEnv* env = C3D_GetTexEnv(0);
+	C3D_TexEnvInit(env);
+	C3D_TexEnvSrc(env, C3D_Both, GPU_PRIMARY_COLOR, 0, 0);
+	C3D_TexEnvFunc(env, C3D_Both, GPU_REPLACE);
+}
+
+void gpuExit(void)
+{
+	// Free the shader program
+	shaderProgramFree(&program);
+	DVLB_Free(vshader_dvlb);
+
+	C3D_Fini();
+}
+
+void* gpuAllocVertices(size_t size)
+{
+	return linearAlloc(size);
+}
+
+void gpuFreeVertices(void* data)
+{
+	linearFree(data);
+}
+
+void gpuBindVertices(void* data, size_t stride)
+{
+	// Configure buffers
+	C3D_BufInfo* bufInfo = C3D_GetBufInfo();
+	BufInfo_Init(bufInfo);
+	BufInfo_Add(bufInfo, data, stride, 1, 0x0);
+}
+
+void gpuVerticesWritten(const void* data, size_t size)
+{
+	// Make the CPU's writes visible to the GPU
+	GSPGPU_FlushDataCache(data, size);
+}
+
+void gpuFrameBegin(void)
+{
+	C3D_FrameBegin(C3D_FRAME_SYNCDRAW);
+}
+
+void gpuFrameEnd(void)
+{
+	C3D_FrameEnd(0);
+}
+
+void gpuBeginTarget(gpu_target target)
+{
+	C3D_RenderTargetClear(targets[target], C3D_CLEAR_ALL, CLEAR_COLOR, 0);
+	C3D_FrameDrawOn(targets[target]);
+}
+
+void gpuSetColor(float r, float g, float b, float a)
+{
+	C3D_FixedAttribSet(1, r, g, b, a);
+}
+
+void gpuSetProjection(gpu_target target, float eyeShift)
+{
+	if (target == TARGET_BOTTOM)
+	{
+		C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, uLoc_projection, &projectionBot);
+		return;
+	}
+
+	// Reuse projectionTop, offset sideways for this eye
+	C3D_Mtx projection;
+	Mtx_Copy(&projection, &projectionTop);
+	Mtx_Translate(&projection, eyeShift, 0.0f, 0.0f, true);
+	C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, uLoc_projection, &projection);
+}
+
+void gpuDrawTriangles(int first, int count)
+{
+	C3D_DrawArrays(GPU_TRIANGLES, first, count);
+}
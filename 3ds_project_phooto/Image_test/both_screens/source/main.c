@@ -1,111 +1,24 @@
 #include <3ds.h>
-#include <citro3d.h>
-#include <string.h>
-#include "vshader_shbin.h"
+#include "gpu.h"
+#include "scene.h"
 
-#define CLEAR_COLOR 0x68B0D8FF
-
-#define DISPLAY_TRANSFER_FLAGS \
-	(GX_TRANSFER_FLIP_VERT(0) | GX_TRANSFER_OUT_TILED(0) | GX_TRANSFER_RAW_COPY(0) | \
-	GX_TRANSFER_IN_FORMAT(GX_TRANSFER_FMT_RGBA8) | GX_TRANSFER_OUT_FORMAT(GX_TRANSFER_FMT_RGB8) | \
-	GX_TRANSFER_SCALING(GX_TRANSFER_SCALE_NO))
-
-typedef struct { float x, y, z; } vertex;
-
-static const vertex vertex_list[] =
-{
-	{    0.0f, 200.0f, 0.5f },
-	{ -100.0f,  40.0f, 0.5f },
-	{ +100.0f,  40.0f, 0.5f },
-};
-
-#define vertex_list_count (sizeof(vertex_list)/sizeof(vertex_list[0]))
-
-static DVLB_s* vshader_dvlb;
-static shaderProgram_s program;
-static int uLoc_projection;
-static C3D_Mtx projectionTop, projectionBot;
-
-static void* vbo_data;
-
-static void sceneInit(void)
-{
-	// Load the vertex shader, create a shader program and bind it
-	vshader_dvlb = DVLB_ParseFile((u32*)vshader_shbin, vshader_shbin_size);
-	shaderProgramInit(&program);
-	shaderProgramSetVsh(&program, &vshader_dvlb->DVLE[0]);
-	C3D_BindProgram(&program);
-
-	// Get the location of the uniforms
-	uLoc_projection = shaderInstanceGetUniformLocation(program.vertexShader, "projection");
-
-	// Configure attributes for use with the vertex shader
-	C3D_AttrInfo* attrInfo = C3D_GetAttrInfo();
-	AttrInfo_Init(attrInfo);
-	AttrInfo_AddLoader(attrInfo, 0, GPU_FLOAT, 3); // v0=position
-	AttrInfo_AddFixed(attrInfo, 1); // v1=color
-
-	// Set the fixed attribute (color) to solid white
-	C3D_FixedAttribSet(1, 1.0, 1.0, 1.0, 1.0);
-
-	// Compute the projection matrix
-	Mtx_OrthoTilt(&projectionTop, -200.0f, 200.0f, 0.0f, 240.0f, 0.0f, 1.0f, true);
-	Mtx_OrthoTilt(&projectionBot, -160.0f, 160.0f, 0.0f, 240.0f, 0.0f, 1.0f, true);
-
-	// Create the VBO (vertex buffer object)
-	vbo_data = linearAlloc(sizeof(vertex_list));
-	memcpy(vbo_data, vertex_list, sizeof(vertex_list));
-
-	// Configure buffers
-	C3D_BufInfo* bufInfo = C3D_GetBufInfo();
-	BufInfo_Init(bufInfo);
-	BufInfo_Add(bufInfo, vbo_data, sizeof(vertex), 1, 0x0);
-
-	// Configure the first fragment shading substage to just pass through the vertex color
-	// See https://www.opengl.org/sdk/docs/man2/xhtml/glTexEnv.xml for more insight
-	C3D_TexEnv* env = C3D_GetTexEnv(0);
-	C3D_TexEnvInit(env);
-	C3D_TexEnvSrc(env, C3D_Both, GPU_PRIMARY_COLOR, 0, 0);
-	C3D_TexEnvFunc(env, C3D_Both, GPU_REPLACE);
-}
-
-static void sceneRender(float a, bool top)
-{
-	float b = (cosf(C3D_Angle(a)) + 1.0f) / 2.0f;
-	if (!top) b = 1.0f - b;
-
-	C3D_FixedAttribSet(1, b, b, b, 1.0);
-	// Update the uniforms
-	C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, uLoc_projection, top ? &projectionTop : &projectionBot);
-
-	// Draw the VBO
-	C3D_DrawArrays(GPU_TRIANGLES, 0, vertex_list_count);
-}
-
-static void sceneExit(void)
-{
-	// Free the VBO
-	linearFree(vbo_data);
-
-	// Free the shader program
-	shaderProgramFree(&program);
-	DVLB_Free(vshader_dvlb);
-}
+#define STEREO_MAX_SHIFT 6.0f // Eye offset in pixels with the 3D slider all the way up
 
 int main()
 {
-	// Initialize graphics
+	// Initialize graphics; the right eye's target is created up front so
+	// stereo can be switched on whenever the 3D slider is raised
 	gfxInitDefault();
-	C3D_Init(C3D_DEFAULT_CMDBUF_SIZE);
-
-	// Initialize the render target
-	C3D_RenderTarget* top = C3D_RenderTargetCreate(240, 400, GPU_RB_RGBA8, GPU_RB_DEPTH24_STENCIL8);
-	C3D_RenderTargetSetOutput(top, GFX_TOP, GFX_LEFT, DISPLAY_TRANSFER_FLAGS);
-	C3D_RenderTarget* bot = C3D_RenderTargetCreate(240, 320, GPU_RB_RGBA8, GPU_RB_DEPTH24_STENCIL8);
-	C3D_RenderTargetSetOutput(bot, GFX_BOTTOM, GFX_LEFT, DISPLAY_TRANSFER_FLAGS);
+	gpuInit(true);
+	bool stereo = false;
 
 	// Initialize the scene
-	sceneInit();
+	if (!sceneInit())
+	{
+		gpuExit();
+		gfxExit();
+		return 1;
+	}
 
 	// Main loop
 	float count = 0.0f;
@@ -118,15 +31,14 @@ int main()
 		if (kDown & KEY_START)
 			break; // break in order to return to hbmenu
 
-		// Render the scene
-		C3D_FrameBegin(C3D_FRAME_SYNCDRAW);
-			C3D_RenderTargetClear(top, C3D_CLEAR_ALL, CLEAR_COLOR, 0);
-			C3D_FrameDrawOn(top);
-			sceneRender(count, true);
-			C3D_RenderTargetClear(bot, C3D_CLEAR_ALL, CLEAR_COLOR, 0);
-			C3D_FrameDrawOn(bot);
-			sceneRender(count, false);
-		C3D_FrameEnd(0);
+		// Render the scene; with the slider down only one eye is drawn
+		float iod = osGet3DSliderState() * STEREO_MAX_SHIFT;
+		if ((iod > 0.0f) != stereo)
+		{
+			stereo = iod > 0.0f;
+			gfxSet3D(stereo);
+		}
+		sceneRender(count, stereo, iod);
 		count += 1/128.0f;
 	}
 
@@ -134,7 +46,7 @@ int main()
 	sceneExit();
 
 	// Deinitialize graphics
-	C3D_Fini();
+	gpuExit();
 	gfxExit();
 	return 0;
 }
@@ -0,0 +1,166 @@
+#include <stdlib.h>
+#include <string.h>
+#include "maze_mesh.h"
+
+#define PELLET_SIZE 2.0f    // Pellet quad size in pixels
+#define SCREEN_HEIGHT 240.0f
+
+// Two triangles covering x0..x1, y0..y1 (screen pixels, y down)
+static vertex* writeQuad(vertex* v, const maze_mesh* mesh, float x0, float y0, float x1, float y1)
+{
+	// The projection has y pointing up from the bottom of the screen
+	float left = mesh->left + x0, right = mesh->left + x1;
+	float bottom = SCREEN_HEIGHT - (mesh->top + y1), top = SCREEN_HEIGHT - (mesh->top + y0);
+	vertex quad[MAZE_MESH_QUAD_VERTICES] =
+	{
+		{ left, bottom, 0.5f }, { right, bottom, 0.5f }, { right, top, 0.5f },
+		{ left, bottom, 0.5f }, { right, top, 0.5f }, { left, top, 0.5f },
+	};
+	memcpy(v, quad, sizeof(quad));
+	return v + MAZE_MESH_QUAD_VERTICES;
+}
+
+// One quad per horizontal run of wall tiles, so a long wall costs the same as a short one
+static int bakeWalls(maze_mesh* mesh, const char* const* rows, vertex* out)
+{
+	int quads = 0;
+	for (int y = 0; y < mesh->height; y++)
+	{
+		for (int x = 0; x < mesh->width; x++)
+		{
+			if (rows[y][x] != '#')
+				continue;
+			int start = x;
+			while (x + 1 < mesh->width && rows[y][x + 1] == '#')
+				x++;
+			if (out)
+				writeQuad(out + quads * MAZE_MESH_QUAD_VERTICES, mesh, start * mesh->tileWidth, y * mesh->tileHeight,
+					(x + 1) * mesh->tileWidth, (y + 1) * mesh->tileHeight);
+			quads++;
+		}
+	}
+	return quads * MAZE_MESH_QUAD_VERTICES;
+}
+
+static void writePellet(maze_mesh* mesh, int index, int x, int y)
+{
+	float cx = (x + 0.5f) * mesh->tileWidth, cy = (y + 0.5f) * mesh->tileHeight;
+	writeQuad(mesh->pellets + index * MAZE_MESH_QUAD_VERTICES, mesh,
+		cx - PELLET_SIZE / 2, cy - PELLET_SIZE / 2, cx + PELLET_SIZE / 2, cy + PELLET_SIZE / 2);
+}
+
+bool mazeMeshLoad(maze_mesh* mesh, const char* const* rows, int width, int height,
+	float tileWidth, float tileHeight, float left, float top)
+{
+	memset(mesh, 0, sizeof(*mesh));
+	mesh->width = width;
+	mesh->height = height;
+	mesh->tileWidth = tileWidth;
+	mesh->tileHeight = tileHeight;
+	mesh->left = left;
+	mesh->top = top;
+
+	mesh->pelletSlot = (int*)malloc(width * height * sizeof(int));
+	if (!mesh->pelletSlot)
+		return false;
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+			mesh->pelletSlot[y * width + x] = rows[y][x] == '.' ? mesh->pelletCount++ : -1;
+	mesh->pendingHides = (int*)malloc((mesh->pelletCount + 1) * sizeof(int));
+
+	// Buffers live in GPU-visible memory for the whole level
+	mesh->wallVertices = bakeWalls(mesh, rows, NULL);
+	mesh->walls = (vertex*)gpuAllocVertices((mesh->wallVertices + 1) * sizeof(vertex));
+	mesh->pellets = (vertex*)gpuAllocVertices((mesh->pelletCount * MAZE_MESH_QUAD_VERTICES + 1) * sizeof(vertex));
+	mesh->actors = (vertex*)gpuAllocVertices(MAZE_MESH_MAX_ACTORS * MAZE_MESH_QUAD_VERTICES * sizeof(vertex));
+	if (!mesh->pendingHides || !mesh->walls || !mesh->pellets || !mesh->actors)
+	{
+		mazeMeshFree(mesh);
+		return false;
+	}
+
+	bakeWalls(mesh, rows, mesh->walls);
+	gpuVerticesWritten(mesh->walls, mesh->wallVertices * sizeof(vertex));
+
+	for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+			if (mesh->pelletSlot[y * width + x] >= 0)
+				writePellet(mesh, mesh->pelletSlot[y * width + x], x, y);
+	gpuVerticesWritten(mesh->pellets, mesh->pelletCount * MAZE_MESH_QUAD_VERTICES * sizeof(vertex));
+	return true;
+}
+
+void mazeMeshFree(maze_mesh* mesh)
+{
+	if (mesh->walls)
+		gpuFreeVertices(mesh->walls);
+	if (mesh->pellets)
+		gpuFreeVertices(mesh->pellets);
+	if (mesh->actors)
+		gpuFreeVertices(mesh->actors);
+	free(mesh->pelletSlot);
+	free(mesh->pendingHides);
+	memset(mesh, 0, sizeof(*mesh));
+}
+
+void mazeMeshHidePellet(maze_mesh* mesh, int x, int y)
+{
+	if (x < 0 || x >= mesh->width || y < 0 || y >= mesh->height)
+		return;
+	int* slot = &mesh->pelletSlot[y * mesh->width + x];
+	if (*slot < 0)
+		return;
+	mesh->pendingHides[mesh->pendingCount++] = *slot;
+	*slot = -1; // Each pellet is queued at most once, so the queue can't overflow
+}
+
+void mazeMeshSetActor(maze_mesh* mesh, int actor, float x, float y)
+{
+	if (actor < 0 || actor >= MAZE_MESH_MAX_ACTORS)
+		return;
+	mesh->actorX[actor] = x;
+	mesh->actorY[actor] = y;
+	if (actor >= mesh->actorCount)
+		mesh->actorCount = actor + 1;
+}
+
+void mazeMeshUpdate(maze_mesh* mesh)
+{
+	// Eaten pellets: collapse the quad onto one point so it covers no pixels
+	for (int i = 0; i < mesh->pendingCount; i++)
+	{
+		vertex* quad = mesh->pellets + mesh->pendingHides[i] * MAZE_MESH_QUAD_VERTICES;
+		for (int v = 1; v < MAZE_MESH_QUAD_VERTICES; v++)
+			quad[v] = quad[0];
+		gpuVerticesWritten(quad, MAZE_MESH_QUAD_VERTICES * sizeof(vertex));
+	}
+	mesh->pendingCount = 0;
+
+	// Actors, one tile-sized quad each with a one pixel margin
+	for (int i = 0; i < mesh->actorCount; i++)
+	{
+		float x = mesh->actorX[i] * mesh->tileWidth, y = mesh->actorY[i] * mesh->tileHeight;
+		writeQuad(mesh->actors + i * MAZE_MESH_QUAD_VERTICES, mesh,
+			x + 1.0f, y + 1.0f, x + mesh->tileWidth - 1.0f, y + mesh->tileHeight - 1.0f);
+	}
+	if (mesh->actorCount)
+		gpuVerticesWritten(mesh->actors, mesh->actorCount * MAZE_MESH_QUAD_VERTICES * sizeof(vertex));
+}
+
+void mazeMeshDraw(const maze_mesh* mesh)
+{
+	gpuBindVertices(mesh->walls, sizeof(vertex));
+	gpuSetColor(0.13f, 0.13f, 0.75f, 1.0f); // Blue
+	gpuDrawTriangles(0, mesh->wallVertices);
+
+	gpuBindVertices(mesh->pellets, sizeof(vertex));
+	gpuSetColor(1.0f, 1.0f, 1.0f, 1.0f);
+	gpuDrawTriangles(0, mesh->pelletCount * MAZE_MESH_QUAD_VERTICES);
+
+	if (mesh->actorCount)
+	{
+		gpuBindVertices(mesh->actors, sizeof(vertex));
+		gpuSetColor(1.0f, 1.0f, 0.0f, 1.0f); // Yellow
+		gpuDrawTriangles(0, mesh->actorCount * MAZE_MESH_QUAD_VERTICES);
+	}
+}
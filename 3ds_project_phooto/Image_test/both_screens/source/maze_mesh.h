@@ -0,0 +1,54 @@
+#ifndef MAZE_MESH_H
+#define MAZE_MESH_H
+
+#include <stdbool.h>
+#include "gpu.h"
+#include "scene.h"
+
+#define MAZE_MESH_MAX_ACTORS 5 // Pac-Man and four ghosts
+#define MAZE_MESH_QUAD_VERTICES 6 // Two triangles per wall run, pellet or actor
+
+// GPU geometry for one maze, split by how often it changes:
+//   walls   - baked into their own buffer at load and never written again
+//   pellets - one quad each, written at load; eating one collapses its
+//             quad in place, touching only that quad's vertices
+//   actors  - the only vertices rewritten every frame
+// Per-frame vertex writes therefore depend on the number of actors and
+// pellets eaten that frame, not on the size of the maze.
+typedef struct
+{
+	int width, height;
+	float tileWidth, tileHeight;
+	float left, top;       // Screen position of the maze's top-left corner
+
+	vertex* walls;
+	int wallVertices;
+
+	vertex* pellets;
+	int pelletCount;
+	int* pelletSlot;       // Pellet index by tile, -1 if the tile has none
+	int* pendingHides;     // Pellets eaten since the last update
+	int pendingCount;
+
+	vertex* actors;
+	int actorCount;
+	float actorX[MAZE_MESH_MAX_ACTORS], actorY[MAZE_MESH_MAX_ACTORS]; // In tiles
+} maze_mesh;
+
+// Level load: bake the walls ('#') and pellets ('.') of rows[height][width].
+// Returns false, with nothing left allocated, if a buffer can't be allocated.
+bool mazeMeshLoad(maze_mesh* mesh, const char* const* rows, int width, int height,
+	float tileWidth, float tileHeight, float left, float top);
+void mazeMeshFree(maze_mesh* mesh);
+
+// Game side: may be called any time; the GPU copy changes in mazeMeshUpdate()
+void mazeMeshHidePellet(maze_mesh* mesh, int x, int y);
+void mazeMeshSetActor(maze_mesh* mesh, int actor, float x, float y);
+
+// Once per frame, after gpuFrameBegin(): write moved actors and eaten pellets
+void mazeMeshUpdate(maze_mesh* mesh);
+
+// Draw on the current target with the current projection
+void mazeMeshDraw(const maze_mesh* mesh);
+
+#endif
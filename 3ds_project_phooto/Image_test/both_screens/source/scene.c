@@ -0,0 +1,102 @@
+#include <math.h>
+#include <string.h>
+#include "gpu.h"
+#include "maze_layout.h"
+#include "maze_mesh.h"
+#include "scene.h"
+
+#define SCENE_TAU 6.28318531f
+#define PACMAN_ROW 1           // Pac-Man walks this corridor, eating as it goes
+#define PACMAN_FRAMES_PER_TILE 8
+
+// The game's maze, from the shared layout
+static const char* const maze_rows[MAZE_HEIGHT] = { MAZE_LAYOUT_ROWS };
+
+static const vertex vertex_list[] =
+{
+	{    0.0f, 200.0f, 0.5f },
+	{ -100.0f,  40.0f, 0.5f },
+	{ +100.0f,  40.0f, 0.5f },
+};
+
+#define vertex_list_count (sizeof(vertex_list)/sizeof(vertex_list[0]))
+
+static vertex* vbo_data;
+static float botColor;
+static maze_mesh maze;
+static int frame;
+
+bool sceneInit(void)
+{
+	// Create the VBO (vertex buffer object); the triangle never changes,
+	// so it is written here and only drawn from then on
+	vbo_data = (vertex*)gpuAllocVertices(sizeof(vertex_list));
+	if (!vbo_data)
+		return false;
+	memcpy(vbo_data, vertex_list, sizeof(vertex_list));
+	gpuVerticesWritten(vbo_data, sizeof(vertex_list));
+
+	// Level load: the maze's walls and pellets go to the GPU once, here
+	if (!mazeMeshLoad(&maze, maze_rows, MAZE_WIDTH, MAZE_HEIGHT, SCENE_TILE_WIDTH, SCENE_TILE_HEIGHT,
+		SCENE_MAZE_LEFT(MAZE_WIDTH * SCENE_TILE_WIDTH), SCENE_MAZE_TOP(MAZE_HEIGHT * SCENE_TILE_HEIGHT)))
+	{
+		gpuFreeVertices(vbo_data);
+		return false;
+	}
+	frame = 0;
+	return true;
+}
+
+// CPU side of the frame: everything here runs once, however many eyes are drawn
+static void sceneBuild(float a)
+{
+	botColor = (cosf(a * SCENE_TAU) + 1.0f) / 2.0f;
+
+	// Pac-Man moves along the corridor and eats the pellet under it;
+	// only its quad and the eaten pellet's quad are written
+	float x = 1.0f + (float)(frame % (PACMAN_FRAMES_PER_TILE * (MAZE_WIDTH - 3))) / PACMAN_FRAMES_PER_TILE;
+	mazeMeshSetActor(&maze, 0, x, PACMAN_ROW);
+	mazeMeshHidePellet(&maze, (int)(x + 0.5f), PACMAN_ROW);
+	mazeMeshUpdate(&maze);
+	frame++;
+}
+
+// Replay the built frame on one target; only the projection differs per eye.
+// The maze is on the top screen, the triangle on the bottom one.
+static void sceneDraw(gpu_target target, float eyeShift)
+{
+	gpuBeginTarget(target);
+	gpuSetProjection(target, eyeShift);
+	if (target == TARGET_BOTTOM)
+	{
+		gpuBindVertices(vbo_data, sizeof(vertex));
+		gpuSetColor(botColor, botColor, botColor, 1.0f);
+		gpuDrawTriangles(0, vertex_list_count);
+	}
+	else
+		mazeMeshDraw(&maze);
+}
+
+void sceneRender(float a, bool stereo, float iod)
+{
+	// Wait for the GPU to finish the last frame before touching its vertices
+	gpuFrameBegin();
+	sceneBuild(a);
+
+	if (stereo)
+	{
+		sceneDraw(TARGET_TOP_LEFT, -iod);
+		sceneDraw(TARGET_TOP_RIGHT, iod);
+	}
+	else
+		sceneDraw(TARGET_TOP_LEFT, 0.0f);
+	sceneDraw(TARGET_BOTTOM, 0.0f);
+	gpuFrameEnd();
+}
+
+void sceneExit(void)
+{
+	// Free the VBOs
+	mazeMeshFree(&maze);
+	gpuFreeVertices(vbo_data);
+}
@@ -0,0 +1,23 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <stdbool.h>
+
+typedef struct { float x, y, z; } vertex;
+
+#define SCENE_TILE_WIDTH 8.0f  // Same tile size as the game's framebuffer renderer
+#define SCENE_TILE_HEIGHT 12.0f
+
+// Top-left corner that centres a maze this many pixels across on the top screen
+#define SCENE_MAZE_LEFT(pixelWidth) ((400.0f - (pixelWidth)) / 2 - 200.0f)
+#define SCENE_MAZE_TOP(pixelHeight) ((240.0f - (pixelHeight)) / 2)
+
+bool sceneInit(void); // False if the scene's vertex buffers can't be allocated
+void sceneExit(void);
+
+// Build the frame's vertex data once, then draw it on every target.
+// In stereo mode the top screen is drawn twice from the same data, each
+// eye shifted by iod pixels in opposite directions.
+void sceneRender(float a, bool stereo, float iod);
+
+#endif